@@ -0,0 +1,75 @@
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include <avr/io.h>
+#include <stdint.h>
+
+// Debounces a contact (push-button, tilt switch) on INT0 (D2) or INT1 (D3) in its ISRs, so a bouncing contact
+// costs two interrupts per change instead of one per bounce, and loop() sees one clean event.
+//
+// The pin's attachInterrupt handler calls PinChanged, which masks the pin interrupt and arms a one-shot
+// SettleMs away on Timer1's compare channel B; the bounces meanwhile only set the pin's EIFR flag.
+// ISR(TIMER1_COMPB_vect) calls Sample, which clears that flag, unmasks the pin and only then reads it, so
+// an edge after the read re-enters PinChanged as soon as the ISR returns and no change is lost. SettleMs
+// must outlast the contact's bounce: a contact still moving when it is read may report an extra change
+// and its reversal before it settles.
+//
+// Timer1 must tick every 16 us (prescaler 256), as the ping timer of Task1.4D does; Begin starts it that way,
+// free-running, when the sketch does not use it. Timer2 is not an option: tone() takes it over. One input per
+// sketch, since it owns TIMER1_COMPB.
+
+enum DebounceResult : uint8_t {
+  debounceChanged, // settled at the other level
+  debounceGlitch   // settled back at the level it left
+};
+
+template <uint8_t Interrupt, uint8_t SettleMs>
+struct DebouncedInput {
+  static_assert(Interrupt == 0 || Interrupt == 1, "only INT0 (D2) and INT1 (D3) are external interrupts");
+  static constexpr uint8_t kPinMask = 1 << (2 + Interrupt); // PD2 / PD3
+  static constexpr uint16_t kSettleTicks = SettleMs * 125u / 2; // 16 us ticks
+
+  // Takes the pin's current level as settled; call from setup() after pinMode and after any Timer1 setup
+  void Begin() {
+    fLevel = ReadPin();
+    if (!(TCCR1B & ((1 << CS12) | (1 << CS11) | (1 << CS10)))) {
+      TCCR1B |= (1 << CS12);
+    }
+  }
+
+  // From the pin's attachInterrupt handler
+  void PinChanged() {
+    EIMSK &= ~(1 << (INT0 + Interrupt));
+    Arm();
+  }
+
+  // From ISR(TIMER1_COMPB_vect); fLevel holds the settled level
+  DebounceResult Sample() {
+    TIMSK1 &= ~(1 << OCIE1B);
+    EIFR = (1 << (INTF0 + Interrupt));
+    EIMSK |= (1 << (INT0 + Interrupt));
+    const uint8_t aLevel = ReadPin();
+    if (aLevel == fLevel)
+      return debounceGlitch;
+    fLevel = aLevel;
+    return debounceChanged;
+  }
+
+  // Compare match kSettleTicks from now, wrapping at the top of the count (OCR1A in CTC mode)
+  static void Arm() {
+    const uint32_t aTop = (TCCR1B & (1 << WGM12)) ? OCR1A : 0xFFFF;
+    uint32_t aAt = TCNT1 + static_cast<uint32_t>(kSettleTicks);
+    if (aAt > aTop) {
+      aAt -= aTop + 1;
+    }
+    OCR1B = static_cast<uint16_t>(aAt);
+    TIFR1 = (1 << OCF1B);
+    TIMSK1 |= (1 << OCIE1B);
+  }
+
+  static uint8_t ReadPin() { return (PIND & kPinMask) ? 1 : 0; }
+
+  uint8_t fLevel = 0;
+};
+
+#endif // DEBOUNCE_H
@@ -0,0 +1,59 @@
+#ifndef EVENT_RING_H
+#define EVENT_RING_H
+
+#include <stdint.h>
+
+// Lock-free single-producer/single-consumer ring for handing ISR events to loop(). ISRs do not nest on the
+// AVR, so every ISR that pushes counts as the one producer; loop() is the consumer. Each side owns one
+// index (head for the producer, tail for the consumer) and only reads the other's, so neither needs
+// interrupts disabled. Indices are single bytes, which the AVR loads and stores atomically, and run freely
+// modulo 256, which is why the capacity must be a power of two no larger than 128.
+//
+// The GCC __atomic builtins keep the event store ordered before the head update (and the event load before
+// the tail update); on the AVR they compile to plain loads and stores, on a multi-core host to the barriers
+// the host test needs.
+template <typename T, uint8_t Capacity>
+struct EventRing {
+  static_assert(Capacity && (Capacity & (Capacity - 1)) == 0 && Capacity <= 128,
+                "capacity must be a power of two no larger than 128");
+
+  // Producer side. Returns false, counting the event as dropped, when the ring is full.
+  bool Push(const T& inEvent) {
+    const uint8_t aHead = __atomic_load_n(&fHead, __ATOMIC_RELAXED);
+    if (static_cast<uint8_t>(aHead - __atomic_load_n(&fTail, __ATOMIC_ACQUIRE)) == Capacity) {
+      const uint8_t aDropped = __atomic_load_n(&fDropped, __ATOMIC_RELAXED);
+      if (aDropped != 0xFF) {
+        __atomic_store_n(&fDropped, static_cast<uint8_t>(aDropped + 1), __ATOMIC_RELAXED);
+      }
+      return false;
+    }
+    fEvents[aHead & (Capacity - 1)] = inEvent;
+    __atomic_store_n(&fHead, static_cast<uint8_t>(aHead + 1), __ATOMIC_RELEASE);
+    return true;
+  }
+
+  // Consumer side. Returns false when the ring is empty.
+  bool Pop(T& outEvent) {
+    const uint8_t aTail = __atomic_load_n(&fTail, __ATOMIC_RELAXED);
+    if (aTail == __atomic_load_n(&fHead, __ATOMIC_ACQUIRE))
+      return false;
+    outEvent = fEvents[aTail & (Capacity - 1)];
+    __atomic_store_n(&fTail, static_cast<uint8_t>(aTail + 1), __ATOMIC_RELEASE);
+    return true;
+  }
+
+  // Events queued right now; exact for the consumer, a lower bound anywhere else
+  uint8_t Size() const {
+    return static_cast<uint8_t>(__atomic_load_n(&fHead, __ATOMIC_ACQUIRE) - __atomic_load_n(&fTail, __ATOMIC_RELAXED));
+  }
+
+  // Events lost to a full ring since the start, saturating at 255
+  uint8_t Dropped() const { return __atomic_load_n(&fDropped, __ATOMIC_RELAXED); }
+
+  T fEvents[Capacity];
+  uint8_t fHead = 0;
+  uint8_t fTail = 0;
+  uint8_t fDropped = 0;
+};
+
+#endif // EVENT_RING_H
@@ -0,0 +1,368 @@
+#ifndef ARDUINO_HOST_HAL_H
+#define ARDUINO_HOST_HAL_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "HostSimulator.h"
+
+// ArduinoHostHAL provides the subset of the Arduino core and avr-libc the Module1 sketches use, backed by
+// HostSimulator, so a sketch compiles unchanged for the host. A driver includes this header, declares the
+// sketch's functions (the Arduino IDE generates those prototypes), includes the sketch .cpp and calls
+// RunSketch.
+//
+// Registers are HostRegister objects: writes to the timer registers reconfigure the simulated Timer1 and
+// Timer0's compare interrupts, writes to EIMSK mask INT0/INT1, writes to ADCSRA start and stop ADC
+// conversions, and reads of TCNT1, PINB/PINC/PIND, the interrupt flag registers and ADC return the simulated
+// state. ISR(vector) defines the handler and registers it with the simulator under the matching HostVector.
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+static constexpr uint8_t LOW = 0;
+static constexpr uint8_t HIGH = 1;
+static constexpr uint8_t INPUT = 0;
+static constexpr uint8_t OUTPUT = 1;
+static constexpr uint8_t INPUT_PULLUP = 2;
+static constexpr uint8_t CHANGE = 1;
+static constexpr uint8_t FALLING = 2;
+static constexpr uint8_t RISING = 3;
+static constexpr uint8_t LED_BUILTIN = 13;
+static constexpr uint8_t A0 = 14;
+static constexpr uint8_t A1 = 15;
+static constexpr uint8_t A2 = 16;
+static constexpr uint8_t A3 = 17;
+static constexpr uint8_t A4 = 18;
+static constexpr uint8_t A5 = 19;
+static constexpr int NOT_AN_INTERRUPT = -1;
+
+// avr/pgmspace.h: the host has a single address space, so flash tables are ordinary constants
+#define PROGMEM
+inline uint8_t pgm_read_byte(const void* inAddress) { return *static_cast<const uint8_t*>(inAddress); }
+inline uint16_t pgm_read_word(const void* inAddress) {
+  uint16_t aWord;
+  memcpy(&aWord, inAddress, sizeof(aWord));
+  return aWord;
+}
+
+// Registers ---------------------------------------------------------------------------------------------------
+
+template <typename T>
+struct HostRegister {
+  explicit HostRegister(const HostRegisterId inId = HostRegisterId::Plain) : fId(inId) {}
+
+  operator T() const { return static_cast<T>(Sim().RegisterRead(fId, fValue)); }
+  HostRegister& operator=(const T inValue) {
+    fValue = inValue;
+    Sim().RegisterWritten(fId);
+    return *this;
+  }
+  HostRegister& operator|=(const T inValue) { return *this = static_cast<T>(fValue | inValue); }
+  HostRegister& operator&=(const T inValue) { return *this = static_cast<T>(fValue & inValue); }
+  HostRegister& operator^=(const T inValue) { return *this = static_cast<T>(fValue ^ inValue); }
+
+  HostRegisterId fId;
+  volatile T fValue = 0;
+};
+
+inline HostRegister<uint8_t> TCCR1A;
+inline HostRegister<uint8_t> TCCR1B(HostRegisterId::TCCR1B);
+inline HostRegister<uint16_t> TCNT1(HostRegisterId::TCNT1);
+inline HostRegister<uint16_t> OCR1A(HostRegisterId::OCR1A);
+inline HostRegister<uint16_t> OCR1B(HostRegisterId::OCR1B);
+inline HostRegister<uint8_t> TIMSK1(HostRegisterId::TIMSK1);
+inline HostRegister<uint8_t> TIFR1(HostRegisterId::TIFR1);
+inline HostRegister<uint8_t> OCR0A(HostRegisterId::OCR0A);
+inline HostRegister<uint8_t> OCR0B(HostRegisterId::OCR0B);
+inline HostRegister<uint8_t> TIMSK0(HostRegisterId::TIMSK0);
+inline HostRegister<uint8_t> PCICR;
+inline HostRegister<uint8_t> PCMSK0;
+inline HostRegister<uint8_t> PCMSK1;
+inline HostRegister<uint8_t> PCMSK2;
+inline HostRegister<uint8_t> PINB(HostRegisterId::PINB);
+inline HostRegister<uint8_t> PINC(HostRegisterId::PINC);
+inline HostRegister<uint8_t> PIND(HostRegisterId::PIND);
+inline HostRegister<uint8_t> EIMSK(HostRegisterId::EIMSK);
+inline HostRegister<uint8_t> EIFR(HostRegisterId::EIFR);
+inline HostRegister<uint8_t> ADMUX;
+inline HostRegister<uint8_t> ADCSRA(HostRegisterId::ADCSRA);
+inline HostRegister<uint8_t> ADCSRB;
+inline HostRegister<uint16_t> ADC(HostRegisterId::ADC);
+
+// TCCR1B
+static constexpr uint8_t CS10 = 0;
+static constexpr uint8_t CS11 = 1;
+static constexpr uint8_t CS12 = 2;
+static constexpr uint8_t WGM12 = 3;
+static constexpr uint8_t WGM13 = 4;
+// TIMSK1
+static constexpr uint8_t TOIE1 = 0;
+static constexpr uint8_t OCIE1A = 1;
+static constexpr uint8_t OCIE1B = 2;
+// TIFR1
+static constexpr uint8_t TOV1 = 0;
+static constexpr uint8_t OCF1A = 1;
+static constexpr uint8_t OCF1B = 2;
+// TIMSK0
+static constexpr uint8_t TOIE0 = 0;
+static constexpr uint8_t OCIE0A = 1;
+static constexpr uint8_t OCIE0B = 2;
+// EIMSK, EIFR
+static constexpr uint8_t INT0 = 0;
+static constexpr uint8_t INT1 = 1;
+static constexpr uint8_t INTF0 = 0;
+static constexpr uint8_t INTF1 = 1;
+// PCICR
+static constexpr uint8_t PCIE0 = 0;
+static constexpr uint8_t PCIE1 = 1;
+static constexpr uint8_t PCIE2 = 2;
+// ADMUX
+static constexpr uint8_t REFS1 = 7;
+static constexpr uint8_t REFS0 = 6;
+static constexpr uint8_t ADLAR = 5;
+// ADCSRA
+static constexpr uint8_t ADEN = 7;
+static constexpr uint8_t ADSC = 6;
+static constexpr uint8_t ADATE = 5;
+static constexpr uint8_t ADIF = 4;
+static constexpr uint8_t ADIE = 3;
+static constexpr uint8_t ADPS2 = 2;
+static constexpr uint8_t ADPS1 = 1;
+static constexpr uint8_t ADPS0 = 0;
+
+typedef struct HostIsrRegistration {
+  HostIsrRegistration(const HostVector inVector, void (*inHandler)(void)) { Sim().SetIsr(inVector, inHandler); }
+} HostIsrRegistration;
+
+#define ISR(vector)                                                                          \
+  void vector##_isr(void);                                                                   \
+  static const HostIsrRegistration vector##_registration(HostVector::vector, vector##_isr); \
+  void vector##_isr(void)
+
+// Arduino core --------------------------------------------------------------------------------------------------
+
+inline void noInterrupts() { Sim().DisableInterrupts(); }
+inline void interrupts() { Sim().EnableInterrupts(); }
+inline void cli() { noInterrupts(); }
+inline void sei() { interrupts(); }
+
+inline uint32_t micros() {
+  Sim().Advance(HostSimulator::kLoopCycles);
+  return static_cast<uint32_t>(Sim().NowUs());
+}
+
+inline uint32_t millis() {
+  Sim().Advance(HostSimulator::kLoopCycles);
+  return static_cast<uint32_t>(Sim().NowUs() / 1000);
+}
+
+inline void delayMicroseconds(const unsigned int inUs) { Sim().Advance(inUs * kCyclesPerUs); }
+inline void delay(const unsigned long inMs) { Sim().Advance(inMs * 1000 * kCyclesPerUs); }
+
+inline void pinMode(const uint8_t inPin, const uint8_t inMode) {
+  HostSimulator& aSim = Sim();
+  aSim.Advance(HostSimulator::kDigitalIoCycles);
+  if (inPin >= kPinCount)
+    return;
+  aSim.fPinModes[inPin] = inMode;
+  if (inMode == INPUT_PULLUP) {
+    aSim.SetPinLevel(inPin, HIGH);
+  }
+}
+
+inline void digitalWrite(const uint8_t inPin, const uint8_t inLevel) {
+  HostSimulator& aSim = Sim();
+  aSim.Advance(HostSimulator::kDigitalIoCycles);
+  if (inPin < kPinCount && aSim.fPinModes[inPin] == OUTPUT) {
+    aSim.SetPinLevel(inPin, inLevel ? HIGH : LOW);
+  }
+}
+
+inline int digitalRead(const uint8_t inPin) {
+  HostSimulator& aSim = Sim();
+  aSim.Advance(HostSimulator::kDigitalIoCycles);
+  return (inPin < kPinCount ? aSim.fPinLevels[inPin] : LOW);
+}
+
+inline int analogRead(uint8_t inPin) {
+  HostSimulator& aSim = Sim();
+  if (inPin < A0) {
+    inPin += A0;
+  }
+  aSim.Advance(HostSimulator::kAnalogReadCycles);
+  if (inPin >= kPinCount)
+    return 0;
+  return (aSim.fAnalogSource ? aSim.fAnalogSource(inPin) : aSim.fAnalogValues[inPin]);
+}
+
+inline void analogWrite(const uint8_t inPin, const int inValue) {
+  Sim().Advance(HostSimulator::kAnalogWriteCycles);
+  (void)inPin;
+  (void)inValue;
+}
+
+inline void tone(const uint8_t inPin, const unsigned int inFrequency, const unsigned long inDurationMs = 0) {
+  Sim().Advance(HostSimulator::kAnalogWriteCycles);
+  (void)inPin;
+  (void)inFrequency;
+  (void)inDurationMs;
+}
+
+// Busy-waits like the AVR pulseIn: for any pulse in progress to end, for the pin to reach inState, then
+// for it to leave it. Interrupts keep firing meanwhile. Returns the pulse width in us, 0 on timeout.
+inline unsigned long pulseIn(const uint8_t inPin, const uint8_t inState, const unsigned long inTimeoutUs = 1000000UL) {
+  HostSimulator& aSim = Sim();
+  const uint64_t aDeadline = aSim.Now() + static_cast<uint64_t>(inTimeoutUs) * kCyclesPerUs;
+  while (aSim.fPinLevels[inPin] == inState) {
+    if (!aSim.AdvanceToNextEvent(aDeadline))
+      return 0;
+  }
+  while (aSim.fPinLevels[inPin] != inState) {
+    if (!aSim.AdvanceToNextEvent(aDeadline))
+      return 0;
+  }
+  const uint64_t aStart = aSim.Now();
+  while (aSim.fPinLevels[inPin] == inState) {
+    if (!aSim.AdvanceToNextEvent(aDeadline))
+      return 0;
+  }
+  return static_cast<unsigned long>((aSim.Now() - aStart) / kCyclesPerUs);
+}
+
+inline int digitalPinToInterrupt(const uint8_t inPin) { return inPin == 2 ? 0 : (inPin == 3 ? 1 : NOT_AN_INTERRUPT); }
+
+inline void HostExternalInterrupt0() { Sim().fExternalHandlers[0](); }
+inline void HostExternalInterrupt1() { Sim().fExternalHandlers[1](); }
+
+inline void attachInterrupt(const int inInterrupt, void (*inHandler)(void), const uint8_t inMode) {
+  if (inInterrupt != 0 && inInterrupt != 1)
+    return;
+  HostSimulator& aSim = Sim();
+  aSim.fExternalHandlers[inInterrupt] = inHandler;
+  aSim.fExternalModes[inInterrupt] = inMode;
+  aSim.SetIsr(inInterrupt == 0 ? HostVector::INT0_vect : HostVector::INT1_vect,
+              inInterrupt == 0 ? HostExternalInterrupt0 : HostExternalInterrupt1);
+  EIMSK |= (1 << inInterrupt);
+}
+
+// avr/sleep.h ---------------------------------------------------------------------------------------------------
+
+// Every mode sleeps the same in the simulator: until the next ISR (see HostSimulator::Sleep)
+static constexpr uint8_t SLEEP_MODE_IDLE = 0x00;
+static constexpr uint8_t SLEEP_MODE_ADC = 0x02;
+static constexpr uint8_t SLEEP_MODE_PWR_DOWN = 0x04;
+static constexpr uint8_t SLEEP_MODE_PWR_SAVE = 0x06;
+
+inline bool hostSleepEnabled = false;
+
+// Each is a read-modify-write of SMCR
+inline void set_sleep_mode(const uint8_t inMode) {
+  Sim().Advance(HostSimulator::kSleepControlCycles);
+  (void)inMode;
+}
+inline void sleep_enable() {
+  Sim().Advance(HostSimulator::kSleepControlCycles);
+  hostSleepEnabled = true;
+}
+inline void sleep_disable() {
+  Sim().Advance(HostSimulator::kSleepControlCycles);
+  hostSleepEnabled = false;
+}
+inline void sleep_cpu() {
+  if (hostSleepEnabled) {
+    Sim().Sleep();
+  }
+}
+
+// Serial ------------------------------------------------------------------------------------------------------
+
+// Models the hardware serial TX path: the bytes are copied into a 64-byte ring that the UART drains at the
+// baud rate, and a write blocks for as long as the ring is full. Every write is timed into fSerialCycles and
+// the bytes go to fSerialOut when set.
+typedef struct HostSerial {
+  void begin(const unsigned long inBaud) { Sim().fSerialBaud = inBaud; }
+
+  size_t write(const uint8_t* inData, const size_t inLength) {
+    HostSimulator& aSim = Sim();
+    const uint64_t aStart = aSim.Now();
+    const uint64_t aByteCycles = ByteCycles();
+    aSim.Advance(inLength * HostSimulator::kSerialByteCopyCycles);
+    aSim.fSerialDrainedAt = std::max(aSim.fSerialDrainedAt, aSim.Now()) + inLength * aByteCycles;
+    const uint64_t aQueued = (aSim.fSerialDrainedAt - aSim.Now()) / aByteCycles;
+    if (aQueued > HostSimulator::kSerialBufferBytes) {
+      aSim.Advance((aQueued - HostSimulator::kSerialBufferBytes) * aByteCycles);
+    }
+    aSim.fSerialBytes += inLength;
+    aSim.fSerialCycles += aSim.Now() - aStart;
+    if (aSim.fSerialOut) {
+      fwrite(inData, 1, inLength, aSim.fSerialOut);
+    }
+    return inLength;
+  }
+  size_t write(const char* inData, const size_t inLength) { return write(reinterpret_cast<const uint8_t*>(inData), inLength); }
+
+  // Bytes a write can take without blocking
+  int availableForWrite() {
+    HostSimulator& aSim = Sim();
+    const uint64_t aQueued =
+      (aSim.fSerialDrainedAt > aSim.Now() ? (aSim.fSerialDrainedAt - aSim.Now() + ByteCycles() - 1) / ByteCycles() : 0);
+    return static_cast<int>(aQueued < HostSimulator::kSerialBufferBytes ? HostSimulator::kSerialBufferBytes - aQueued : 0);
+  }
+
+  size_t print(const char* inText) { return write(inText, strlen(inText)); }
+  size_t print(const int inValue) { return Format("%d", inValue); }
+  size_t print(const unsigned int inValue) { return Format("%u", inValue); }
+  size_t print(const long inValue) { return Format("%ld", inValue); }
+  size_t print(const unsigned long inValue) { return Format("%lu", inValue); }
+  size_t print(const double inValue) { return Format("%.2f", inValue); }
+
+  size_t println() { return write("\r\n", 2); }
+  template <typename T>
+  size_t println(const T inValue) {
+    return print(inValue) + println();
+  }
+
+  private:
+  static uint64_t ByteCycles() { return 10 * 1000000 * kCyclesPerUs / Sim().fSerialBaud; }
+
+  template <typename T>
+  size_t Format(const char* inFormat, const T inValue) {
+    char aText[32];
+    const int aLength = snprintf(aText, sizeof(aText), inFormat, inValue);
+    return write(aText, aLength > 0 ? static_cast<size_t>(aLength) : 0);
+  }
+} HostSerial;
+
+inline HostSerial Serial;
+
+// Driver entry point ----------------------------------------------------------------------------------------------
+
+void setup();
+void loop();
+
+// Binds the registers the simulator models, then runs the sketch for inDurationUs of simulated time
+inline void RunSketch(const uint64_t inDurationUs) {
+  HostSimulator& aSim = Sim();
+  aSim.fEimsk = &EIMSK.fValue;
+  aSim.fEifr = &EIFR.fValue;
+  aSim.fPcicr = &PCICR.fValue;
+  aSim.fPcmsk[0] = &PCMSK0.fValue;
+  aSim.fPcmsk[1] = &PCMSK1.fValue;
+  aSim.fPcmsk[2] = &PCMSK2.fValue;
+  aSim.fTccr1b = &TCCR1B.fValue;
+  aSim.fTimsk1 = &TIMSK1.fValue;
+  aSim.fOcr1[0] = &OCR1A.fValue;
+  aSim.fOcr1[1] = &OCR1B.fValue;
+  aSim.fTifr1 = &TIFR1.fValue;
+  aSim.fTcnt1 = &TCNT1.fValue;
+  aSim.fTimsk0 = &TIMSK0.fValue;
+  aSim.fOcr0[0] = &OCR0A.fValue;
+  aSim.fOcr0[1] = &OCR0B.fValue;
+  aSim.fAdmux = &ADMUX.fValue;
+  aSim.fAdcsra = &ADCSRA.fValue;
+  aSim.fAdcsrb = &ADCSRB.fValue;
+  aSim.Run(setup, loop, inDurationUs);
+}
+
+#endif // ARDUINO_HOST_HAL_H
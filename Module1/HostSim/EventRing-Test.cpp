@@ -0,0 +1,91 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "../EventRing.h"
+
+// Hammers Module1/EventRing.h on the host: a producer thread standing in for the ISRs pushes numbered
+// events as fast as it can while a consumer thread standing in for loop() pops them. Every popped event
+// must be the next one pushed successfully, with its payload intact, and nothing pushed may be lost.
+// A deterministic burst check then fills the ring to capacity and overflows it.
+//
+// Usage: EventRing-Test.o [events]
+
+typedef struct TestEvent {
+  uint32_t sequence;
+  uint32_t check; // ~sequence, catches a torn copy
+} TestEvent;
+
+static constexpr uint8_t capacity = 32;
+
+bool Hammer(const uint32_t events) {
+  EventRing<TestEvent, capacity> ring;
+  uint64_t fullRetries = 0;
+
+  // A push rejected by a full ring is retried, so every event must eventually arrive
+  std::thread producer([&]() {
+    for (uint32_t i = 0; i < events; ++i) {
+      while (!ring.Push({i, ~i})) {
+        fullRetries++;
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  bool ok = true;
+  uint32_t expected = 0;
+  TestEvent event;
+  while (expected < events) {
+    if (!ring.Pop(event)) {
+      std::this_thread::yield();
+      continue;
+    }
+    if (event.sequence != expected || event.check != ~expected) {
+      printf("FAIL: popped %u (check %08x), expected %u\n", event.sequence, event.check, expected);
+      ok = false;
+      break;
+    }
+    expected++;
+  }
+  producer.join();
+
+  printf("hammer: %u events, %u popped in order, %llu pushes retried on a full ring\n", events, expected,
+         static_cast<unsigned long long>(fullRetries));
+  return ok && expected == events;
+}
+
+bool Burst() {
+  EventRing<TestEvent, capacity> ring;
+  bool ok = true;
+  for (uint32_t i = 0; i < capacity; ++i) {
+    ok &= ring.Push({i, ~i});
+  }
+  ok &= !ring.Push({capacity, ~static_cast<uint32_t>(capacity)}) && ring.Dropped() == 1 && ring.Size() == capacity;
+  TestEvent event;
+  for (uint32_t i = 0; i < capacity; ++i) {
+    ok &= ring.Pop(event) && event.sequence == i;
+  }
+  ok &= !ring.Pop(event) && ring.Size() == 0;
+  // Indices wrap at 256; keep cycling well past that
+  for (uint32_t i = 0; i < 1000; ++i) {
+    ok &= ring.Push({i, ~i}) && ring.Pop(event) && event.sequence == i;
+  }
+  printf("burst: %s\n", ok ? "ok" : "FAIL");
+  return ok;
+}
+
+int main(int argc, char** argv) {
+  uint32_t events = 10000000;
+  if (argc > 1)
+    events = strtoul(argv[1], NULL, 10);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  const bool ok = Burst() && Hammer(events);
+  auto stop = std::chrono::high_resolution_clock::now();
+
+  auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+  printf("duration = %ld microseconds\n", (long)duration.count());
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
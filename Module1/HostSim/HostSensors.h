@@ -0,0 +1,148 @@
+#ifndef HOST_SENSORS_H
+#define HOST_SENSORS_H
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "HostSimulator.h"
+
+// Models of the sensors wired to the Module1 sketches, driving HostSimulator pins the way the hardware does
+
+// A three-pin (Parallax PING)))-style) ultrasonic ranger: the sketch pulses the shared signal pin HIGH as an
+// output, switches it to an input, and the sensor answers after its hold-off with an echo pulse as wide as
+// the sound's round trip, 2 * 29 us per cm, or kMaxEchoUs when nothing answers in time.
+//
+// The sensors share the air. A ping keeps ringing for kRingDownUs after its sound returns (the object's
+// reflection, then weaker multipath), and every sensor hears it: a sensor that is listening ends its echo
+// on the first sound it hears, its own or not. An echo ended by another ping's sound, or by the ring-down
+// of any earlier ping, is crosstalk and its reading is wrong.
+typedef struct PingSensor {
+  static constexpr uint64_t kHoldOffUs = 750;
+  static constexpr uint64_t kUsPerCmRoundTrip = 58;
+  static constexpr uint64_t kMaxEchoUs = 18500;
+  static constexpr uint64_t kRingDownUs = 3000;
+
+  PingSensor(const uint8_t inPin, const std::function<uint16_t()>& inDistanceCm) : fPin(inPin), fDistanceCm(inDistanceCm) {
+    Sensors().push_back(this);
+    Sim().fPinChangeHooks.push_back([this](const uint8_t inChangedPin, const uint8_t inLevel) {
+      HostSimulator& aSim = Sim();
+      // The falling edge of the trigger pulse, while the sketch still drives the pin
+      if (inChangedPin != fPin || inLevel || aSim.fPinModes[fPin] != 1 || fEchoing)
+        return;
+      fEchoing = true;
+      fPings++;
+      const uint64_t aRoundTripUs = fDistanceCm() * kUsPerCmRoundTrip;
+      aSim.AfterUs(kHoldOffUs, [this, aRoundTripUs]() { Listen(aRoundTripUs); });
+    });
+  }
+
+  // The burst goes out as the echo pulse starts
+  void Listen(const uint64_t inRoundTripUs) {
+    HostSimulator& aSim = Sim();
+    Sim().SetPinLevel(fPin, 1);
+    const uint64_t aGeneration = ++fGeneration;
+    if (aSim.NowUs() < QuietAtUs()) {
+      // Still ringing from an earlier ping
+      aSim.AfterUs(1, [this, aGeneration]() { EndEcho(aGeneration, &fCrosstalk); });
+    } else if (inRoundTripUs < kMaxEchoUs) {
+      aSim.AfterUs(inRoundTripUs, [this, aGeneration]() { EndEcho(aGeneration, &fReadings); });
+    } else {
+      aSim.AfterUs(kMaxEchoUs, [this, aGeneration]() { EndEcho(aGeneration, &fNoEchoes); });
+    }
+    // The sound returns whether or not this sensor still listens, and the others hear it
+    aSim.AfterUs(inRoundTripUs, [this]() {
+      QuietAtUs() = std::max(QuietAtUs(), Sim().NowUs() + kRingDownUs);
+      for (PingSensor* aOther : Sensors()) {
+        if (aOther != this) {
+          aOther->EndEcho(aOther->fGeneration, &aOther->fCrosstalk);
+        }
+      }
+    });
+  }
+
+  void EndEcho(const uint64_t inGeneration, uint64_t* outCount) {
+    if (!fEchoing || inGeneration != fGeneration || !Sim().fPinLevels[fPin])
+      return;
+    (*outCount)++;
+    fEchoing = false;
+    Sim().SetPinLevel(fPin, 0);
+  }
+
+  static std::vector<PingSensor*>& Sensors() {
+    static std::vector<PingSensor*> aSensors;
+    return aSensors;
+  }
+
+  // When the last ping's ring-down has died away
+  static uint64_t& QuietAtUs() {
+    static uint64_t aQuietAtUs = 0;
+    return aQuietAtUs;
+  }
+
+  uint8_t fPin;
+  std::function<uint16_t()> fDistanceCm;
+  bool fEchoing = false;
+  uint64_t fGeneration = 0;
+  uint64_t fPings = 0;
+  uint64_t fReadings = 0; // echoes ended by their own sound
+  uint64_t fNoEchoes = 0; // nothing within kMaxEchoUs
+  uint64_t fCrosstalk = 0;
+} PingSensor;
+
+// A mechanical contact (push-button, tilt switch) that chatters before it settles: every change of state is
+// followed by 4 to inMaxBounces pairs of extra edges, 10-250 us apart (a few ms in all), before the pin
+// rests at the new level. The bounce counts and gaps are pseudo-random but the same on every run.
+typedef struct BouncingContact {
+  BouncingContact(const uint8_t inPin, const uint8_t inMaxBounces = 16) : fPin(inPin), fMaxBounces(inMaxBounces) {}
+
+  // Starts moving the contact to inLevel at inUs and returns when it will have settled, in us
+  uint64_t ChangeAtUs(const uint8_t inLevel, const uint64_t inUs) {
+    const uint8_t aBounces = static_cast<uint8_t>(4 + Random() % (fMaxBounces > 4 ? fMaxBounces - 3 : 1));
+    uint64_t aAtUs = inUs;
+    for (uint8_t i = 0; i <= 2 * aBounces; ++i) {
+      Sim().SetPinLevelAtUs(fPin, (i & 1) ? !inLevel : inLevel, aAtUs);
+      aAtUs += 10 + Random() % 240;
+    }
+    fChanges++;
+    fBounceEdges += 2 * aBounces;
+    return aAtUs;
+  }
+
+  // Presses (to inPressedLevel) every inPeriodUs from inStartUs on, holding each press for inHoldUs
+  void PressEveryUs(const uint8_t inPressedLevel, const uint64_t inPeriodUs, const uint64_t inHoldUs,
+                    const uint64_t inStartUs = 0) {
+    Sim().At(inStartUs * kCyclesPerUs, [this, inPressedLevel, inPeriodUs, inHoldUs, inStartUs]() {
+      ChangeAtUs(inPressedLevel, inStartUs);
+      ChangeAtUs(!inPressedLevel, inStartUs + inHoldUs);
+      fPresses++;
+      PressEveryUs(inPressedLevel, inPeriodUs, inHoldUs, inStartUs + inPeriodUs);
+    });
+  }
+
+  // Flips the contact every inPeriodUs from inStartUs on, like HostSimulator::TogglePinEveryUs
+  void ToggleEveryUs(const uint64_t inPeriodUs, const uint64_t inStartUs = 0) {
+    if (!inPeriodUs)
+      return;
+    Sim().At(inStartUs * kCyclesPerUs, [this, inPeriodUs, inStartUs]() {
+      fLevel = !fLevel;
+      ChangeAtUs(fLevel, inStartUs);
+      ToggleEveryUs(inPeriodUs, inStartUs + inPeriodUs);
+    });
+  }
+
+  uint32_t Random() {
+    fSeed = fSeed * 1103515245u + 12345u;
+    return fSeed >> 16;
+  }
+
+  uint8_t fPin;
+  uint8_t fMaxBounces;
+  uint8_t fLevel = 0; // the level ToggleEveryUs last moved to
+  uint32_t fSeed = 12345;
+  uint64_t fPresses = 0;
+  uint64_t fChanges = 0;
+  uint64_t fBounceEdges = 0;
+} BouncingContact;
+
+#endif // HOST_SENSORS_H
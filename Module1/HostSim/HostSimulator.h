@@ -0,0 +1,836 @@
+#ifndef HOST_SIMULATOR_H
+#define HOST_SIMULATOR_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <string>
+#include <vector>
+
+// HostSimulator is a discrete-event model of the ATmega328P parts the Module1 sketches use, so a sketch can
+// be compiled for the host (see ArduinoHostHAL.h) and its interrupt timing measured deterministically.
+//
+// Time is kept in CPU cycles of the 16 MHz clock and only moves when the sketch calls into the HAL: every
+// Arduino call advances the clock by a modelled cost, pulseIn/delay advance to the edges they wait for,
+// and every loop() pass costs kLoopCycles. While the clock moves, scheduled events (pin stimulus, Timer1
+// and Timer0 compare matches, ADC conversions) fire in order and raise interrupt vectors. As on the AVR, a vector raised while
+// interrupts are disabled or another ISR runs stays pending, and raising it again before it runs is lost.
+//
+// Sleep (avr/sleep.h) idles the CPU until an ISR has run or Timer0's millis() overflow, every 1024 us, wakes
+// it. As on the AVR, sleeping straight after enabling interrupts still sleeps first and is then woken by
+// the ISRs that were pending. Sleeping while a watched flag or queue holds an unhandled event is a missed
+// wakeup: the event waits for an unrelated interrupt. Sleeping with interrupts disabled never wakes.
+//
+// For latency, a sketch's ISR-to-loop flags can be watched: the flag's ISR setting it starts the clock, the
+// loop clearing it stops it, and that ISR firing again while the flag is still set is a missed event.
+// Event queues (Module1/EventRing.h) are watched through their indices: every push by an ISR starts a
+// clock, the matching pop by loop() stops it, and the ring's drop counter gives the missed events.
+
+static constexpr uint64_t kCyclesPerUs = 16;
+static constexpr uint8_t kPinCount = 20; // D0-D13, A0-A5 (14-19)
+
+// In AVR vector order, which is also the dispatch priority
+enum class HostVector : uint8_t {
+  INT0_vect,
+  INT1_vect,
+  PCINT0_vect,
+  PCINT1_vect,
+  PCINT2_vect,
+  WDT_vect,
+  TIMER2_COMPA_vect,
+  TIMER2_COMPB_vect,
+  TIMER2_OVF_vect,
+  TIMER1_CAPT_vect,
+  TIMER1_COMPA_vect,
+  TIMER1_COMPB_vect,
+  TIMER1_OVF_vect,
+  TIMER0_COMPA_vect,
+  TIMER0_COMPB_vect,
+  TIMER0_OVF_vect,
+  SPI_STC_vect,
+  USART_RX_vect,
+  USART_UDRE_vect,
+  USART_TX_vect,
+  ADC_vect,
+  Count
+};
+
+static const char* const kVectorNames[] = {
+    "INT0",   "INT1",         "PCINT0",       "PCINT1",      "PCINT2",      "WDT",         "TIMER2_COMPA",
+    "TIMER2_COMPB", "TIMER2_OVF", "TIMER1_CAPT", "TIMER1_COMPA", "TIMER1_COMPB", "TIMER1_OVF", "TIMER0_COMPA",
+    "TIMER0_COMPB", "TIMER0_OVF", "SPI_STC",    "USART_RX",    "USART_UDRE",  "USART_TX",    "ADC"};
+
+// Registers the simulator reacts to; the rest of the HAL's registers are plain storage
+enum class HostRegisterId : uint8_t {
+  Plain,
+  TCCR1B,
+  TCNT1,
+  OCR1A,
+  OCR1B,
+  TIMSK1,
+  TIFR1,
+  OCR0A,
+  OCR0B,
+  TIMSK0,
+  PINB,
+  PINC,
+  PIND,
+  EIMSK,
+  EIFR,
+  ADCSRA,
+  ADC
+};
+
+typedef struct VectorStats {
+  uint64_t fCount = 0;
+  uint64_t fLost = 0; // raised again while still pending
+  uint64_t fMaxEntryCycles = 0; // raise to ISR entry
+  uint64_t fMaxRunCycles = 0;
+} VectorStats;
+
+typedef struct WatchedFlag {
+  std::string fName;
+  const volatile uint8_t* fFlag;
+  HostVector fVector; // the ISR that sets the flag
+  uint64_t fSetAt = 0;
+  bool fPending = false;
+  uint64_t fEvents = 0;
+  uint64_t fHandled = 0;
+  uint64_t fMissed = 0; // ISR fired again before loop() consumed the previous event
+  uint64_t fLate = 0; // consumed later than the latency budget
+  uint64_t fTotalLatencyCycles = 0;
+  uint64_t fMaxLatencyCycles = 0;
+} WatchedFlag;
+
+typedef struct WatchedQueue {
+  std::string fName;
+  const uint8_t* fHead;
+  const uint8_t* fTail;
+  const uint8_t* fDropped;
+  uint8_t fSeenHead = 0;
+  uint8_t fSeenTail = 0;
+  std::deque<uint64_t> fPushedAt;
+  uint64_t fEvents = 0;
+  uint64_t fLate = 0;
+  uint64_t fTotalLatencyCycles = 0;
+  uint64_t fMaxLatencyCycles = 0;
+  std::size_t fMaxDepth = 0;
+} WatchedQueue;
+
+typedef struct SimEvent {
+  uint64_t fAt;
+  uint64_t fSequence; // keeps events scheduled for the same cycle in scheduling order
+  std::function<void()> fAction;
+  bool operator>(const SimEvent& inOther) const {
+    return fAt != inOther.fAt ? fAt > inOther.fAt : fSequence > inOther.fSequence;
+  }
+} SimEvent;
+
+typedef struct HostSimulator {
+  // Modelled costs of the Arduino core calls, in cycles
+  static constexpr uint64_t kLoopCycles = 16;
+  static constexpr uint64_t kIsrEntryCycles = 40; // vector jump, register save/restore, reti
+  static constexpr uint64_t kDigitalIoCycles = 80;
+  static constexpr uint64_t kAnalogWriteCycles = 120;
+  static constexpr uint64_t kAnalogReadCycles = 112 * kCyclesPerUs;
+  static constexpr uint64_t kSerialByteCopyCycles = 40;
+  static constexpr uint64_t kSerialBufferBytes = 64;
+  static constexpr uint64_t kSleepControlCycles = 3;
+
+  uint64_t Now() const { return fNow; }
+  uint64_t NowUs() const { return fNow / kCyclesPerUs; }
+
+  void At(const uint64_t inCycle, const std::function<void()>& inAction) {
+    fEvents.push({inCycle < fNow ? fNow : inCycle, fSequence++, inAction});
+  }
+
+  void AfterUs(const uint64_t inUs, const std::function<void()>& inAction) { At(fNow + inUs * kCyclesPerUs, inAction); }
+
+  // Moves the clock forward by inCycles of the caller's own work, firing every event due on the way. ISRs
+  // that run meanwhile pause the caller, so their cycles push its end out by as much.
+  void Advance(const uint64_t inCycles) {
+    const uint64_t aTarget = fNow + inCycles;
+    const uint64_t aIsrCyclesBefore = fIsrCycles;
+    for (;;) {
+      const uint64_t aEnd = aTarget + (fInIsr ? 0 : fIsrCycles - aIsrCyclesBefore);
+      if (fEvents.empty() || fEvents.top().fAt > aEnd) {
+        fNow = std::max(fNow, aEnd);
+        break;
+      }
+      SimEvent aEvent = fEvents.top();
+      fEvents.pop();
+      fNow = std::max(fNow, aEvent.fAt);
+      aEvent.fAction();
+    }
+    if (!fInIsr) {
+      CheckFlagsConsumed();
+    }
+  }
+
+  // Advances to the next event, or to inLimit if that comes first. Returns false once inLimit is reached.
+  bool AdvanceToNextEvent(const uint64_t inLimit) {
+    if (fNow >= inLimit)
+      return false;
+    const uint64_t aNext = (fEvents.empty() ? inLimit : std::min(fEvents.top().fAt, inLimit));
+    Advance(aNext > fNow ? aNext - fNow : 0);
+    return fNow < inLimit;
+  }
+
+  // Interrupts ----------------------------------------------------------------------------------------------
+
+  void SetIsr(const HostVector inVector, void (*inHandler)(void)) { fIsrs[static_cast<int>(inVector)] = inHandler; }
+
+  void RaiseVector(const HostVector inVector) {
+    const int aIndex = static_cast<int>(inVector);
+    if (fIsrs[aIndex] == NULL)
+      return;
+    if (fPending & (1u << aIndex)) {
+      fVectorStats[aIndex].fLost++;
+      return;
+    }
+    fPending |= (1u << aIndex);
+    fRaisedAt[aIndex] = fNow;
+    DispatchPending();
+  }
+
+  // Drops a raised vector whose ISR has not run yet, as clearing its flag does on the AVR
+  void CancelVector(const HostVector inVector) { fPending &= ~(1u << static_cast<int>(inVector)); }
+
+  void DisableInterrupts() {
+    if (fInterruptsEnabled) {
+      fDisabledAt = fNow;
+    }
+    fInterruptsEnabled = false;
+  }
+
+  void EnableInterrupts() {
+    if (!fInterruptsEnabled) {
+      const uint64_t aWindow = fNow - fDisabledAt;
+      fDisabledCycles += aWindow;
+      fMaxDisabledCycles = std::max(fMaxDisabledCycles, aWindow);
+    }
+    fInterruptsEnabled = true;
+    const uint64_t aIsrsBefore = fIsrCount;
+    DispatchPending();
+    fEnabledAt = fNow;
+    fEnableRanIsrs = (fIsrCount != aIsrsBefore);
+  }
+
+  // Sleep -------------------------------------------------------------------------------------------------------
+
+  static constexpr uint64_t kTimer0OverflowCycles = 1024 * kCyclesPerUs;
+
+  void Sleep() {
+    fSleeps++;
+    if (fEnabledAt == fNow && fEnableRanIsrs) {
+      // sei; sleep: the ISRs the sei released run after the sleep instruction and wake the CPU at once
+      fWakeups++;
+      return;
+    }
+    if (!fInterruptsEnabled) {
+      fSleepsWithInterruptsDisabled++;
+      return;
+    }
+    CheckFlagsConsumed(); // the loop may have consumed events since the clock last moved
+    if (EventsPending()) {
+      fMissedWakeups++;
+    }
+    const uint64_t aStart = fNow;
+    const uint64_t aIsrsBefore = fIsrCount;
+    const uint64_t aIsrCyclesBefore = fIsrCycles;
+    const uint64_t aTimer0Overflow = (fNow / kTimer0OverflowCycles + 1) * kTimer0OverflowCycles;
+    while (fIsrCount == aIsrsBefore && AdvanceToNextEvent(aTimer0Overflow)) {
+    }
+    if (fIsrCount == aIsrsBefore) {
+      fTimer0Wakeups++;
+    }
+    fWakeups++;
+    fSleepCycles += (fNow - aStart) - (fIsrCycles - aIsrCyclesBefore);
+  }
+
+  // Latency watch ---------------------------------------------------------------------------------------------
+
+  void WatchFlag(const char* inName, const volatile void* inFlag, const HostVector inVector) {
+    WatchedFlag aFlag;
+    aFlag.fName = inName;
+    aFlag.fFlag = static_cast<const volatile uint8_t*>(inFlag);
+    aFlag.fVector = inVector;
+    fFlags.push_back(aFlag);
+  }
+
+  template <typename Ring>
+  void WatchQueue(const char* inName, const Ring& inRing) {
+    WatchedQueue aQueue;
+    aQueue.fName = inName;
+    aQueue.fHead = &inRing.fHead;
+    aQueue.fTail = &inRing.fTail;
+    aQueue.fDropped = &inRing.fDropped;
+    aQueue.fSeenHead = inRing.fHead;
+    aQueue.fSeenTail = inRing.fTail;
+    fQueues.push_back(aQueue);
+  }
+
+  // Pins ------------------------------------------------------------------------------------------------------
+
+  // Drives an input from the outside world, raising INT0/INT1 and PCINT vectors as configured
+  void SetPinLevel(const uint8_t inPin, const uint8_t inLevel) {
+    if (inPin >= kPinCount || fPinLevels[inPin] == inLevel)
+      return;
+    fPinLevels[inPin] = inLevel;
+    for (const auto& aHook : fPinChangeHooks) {
+      aHook(inPin, inLevel);
+    }
+    for (int i = 0; i < 2; ++i) {
+      if (fExternalPins[i] != inPin || fExternalHandlers[i] == NULL)
+        continue;
+      const bool aRising = (inLevel != 0);
+      // Arduino modes: CHANGE 1, FALLING 2, RISING 3
+      if (fExternalModes[i] == 1 || (fExternalModes[i] == 3 && aRising) || (fExternalModes[i] == 2 && !aRising)) {
+        // A masked edge only sets its flag in EIFR
+        if (fEimsk && !(*fEimsk & (1 << i))) {
+          fExternalFlags |= (1 << i);
+        } else {
+          RaiseVector(i == 0 ? HostVector::INT0_vect : HostVector::INT1_vect);
+        }
+      }
+    }
+    // Pin change interrupts: port B is D8-D13, port C A0-A5, port D D0-D7
+    int aPort = 2;
+    int aBit = inPin;
+    if (inPin >= 14) {
+      aPort = 1;
+      aBit = inPin - 14;
+    } else if (inPin >= 8) {
+      aPort = 0;
+      aBit = inPin - 8;
+    }
+    if (fPcicr && (*fPcicr & (1 << aPort)) && (*fPcmsk[aPort] & (1 << aBit))) {
+      RaiseVector(static_cast<HostVector>(static_cast<int>(HostVector::PCINT0_vect) + aPort));
+    }
+  }
+
+  void SetPinLevelAtUs(const uint8_t inPin, const uint8_t inLevel, const uint64_t inUs) {
+    At(inUs * kCyclesPerUs, [this, inPin, inLevel]() { SetPinLevel(inPin, inLevel); });
+  }
+
+  // Toggles an input every inPeriodUs from inStartUs on
+  void TogglePinEveryUs(const uint8_t inPin, const uint64_t inPeriodUs, const uint64_t inStartUs = 0) {
+    if (!inPeriodUs)
+      return;
+    At(inStartUs * kCyclesPerUs, [this, inPin, inPeriodUs]() {
+      SetPinLevel(inPin, !fPinLevels[inPin]);
+      TogglePinEveryUs(inPin, inPeriodUs, NowUs() + inPeriodUs);
+    });
+  }
+
+  // Registers -------------------------------------------------------------------------------------------------
+
+  void RegisterWritten(const HostRegisterId inId) {
+    switch (inId) {
+      case HostRegisterId::TCNT1:
+        fTimer1Restarts++;
+        fTimer1ZeroAt = fNow - static_cast<uint64_t>(*fTcnt1) * fTimer1Prescaler;
+        fTimer1Held = *fTcnt1;
+        Timer1ControlWritten();
+        break;
+      case HostRegisterId::TCCR1B: {
+        // Starting, stopping or re-prescaling the timer keeps the count it has reached
+        const uint16_t aCount = Timer1Count();
+        fTimer1Prescaler = Timer1Prescaler();
+        fTimer1ZeroAt = fNow - static_cast<uint64_t>(aCount) * fTimer1Prescaler;
+        fTimer1Held = aCount;
+        Timer1ControlWritten();
+        break;
+      }
+      case HostRegisterId::OCR1A:
+      case HostRegisterId::OCR1B:
+      case HostRegisterId::TIMSK1:
+        Timer1ControlWritten();
+        break;
+      case HostRegisterId::TIFR1:
+        // Writing a one clears a flag, and with it a request that has not been served yet
+        for (int i = 0; i < 2; ++i) {
+          if (*fTifr1 & (2 << i)) {
+            fTimer1ClearedAt[i] = fNow;
+            CancelVector(i ? HostVector::TIMER1_COMPB_vect : HostVector::TIMER1_COMPA_vect);
+          }
+        }
+        *fTifr1 = 0;
+        break;
+      case HostRegisterId::OCR0A:
+      case HostRegisterId::OCR0B:
+      case HostRegisterId::TIMSK0:
+        for (int i = 0; i < 2; ++i) {
+          ScheduleTimer0(i);
+        }
+        break;
+      case HostRegisterId::EIMSK:
+        ExternalMaskWritten();
+        break;
+      case HostRegisterId::EIFR:
+        fExternalFlags &= ~*fEifr;
+        for (int i = 0; i < 2; ++i) {
+          if (*fEifr & (1 << i)) {
+            CancelVector(i ? HostVector::INT1_vect : HostVector::INT0_vect);
+          }
+        }
+        *fEifr = 0;
+        break;
+      case HostRegisterId::ADCSRA:
+        AdcControlWritten();
+        break;
+      default:
+        break;
+    }
+  }
+
+  uint16_t RegisterRead(const HostRegisterId inId, const uint16_t inStored) const {
+    switch (inId) {
+      case HostRegisterId::TCNT1:
+        return Timer1Count();
+      case HostRegisterId::TIFR1:
+        return static_cast<uint16_t>((Timer1Flagged(0) ? (1 << 1) : 0) | (Timer1Flagged(1) ? (1 << 2) : 0));
+      case HostRegisterId::PINB:
+        return PortLevels(8, 6);
+      case HostRegisterId::PINC:
+        return PortLevels(14, 6);
+      case HostRegisterId::PIND:
+        return PortLevels(0, 8);
+      case HostRegisterId::EIFR:
+        return fExternalFlags;
+      case HostRegisterId::ADC:
+        return fAdcResult;
+      default:
+        return inStored;
+    }
+  }
+
+  // Main loop ---------------------------------------------------------------------------------------------------
+
+  // Runs setup() once, then loop() until inDurationUs of simulated time has passed
+  void Run(void (*inSetup)(void), void (*inLoop)(void), const uint64_t inDurationUs) {
+    const uint64_t aEnd = fNow + inDurationUs * kCyclesPerUs;
+    inSetup();
+    while (fNow < aEnd) {
+      const uint64_t aPassStart = fNow;
+      inLoop();
+      Advance(kLoopCycles);
+      fLoopPasses++;
+      fLoopCycles += fNow - aPassStart;
+      fMaxLoopCycles = std::max(fMaxLoopCycles, fNow - aPassStart);
+    }
+  }
+
+  // Prints the run's interrupt and latency statistics. Returns false when any watched event was missed or
+  // handled later than the latency budget, or interrupts were held off longer than it, so a CI script can
+  // fail on the exit code.
+  bool Report(FILE* inStream) const {
+    bool aPassed = (!fBudgetCycles || fMaxDisabledCycles <= fBudgetCycles);
+    fprintf(inStream,
+            "simulated = %llu microseconds, loop passes = %llu, mean pass = %.1f cycles, longest pass = %llu "
+            "microseconds\n",
+            static_cast<unsigned long long>(NowUs()), static_cast<unsigned long long>(fLoopPasses),
+            fLoopPasses ? static_cast<double>(fLoopCycles) / fLoopPasses : 0.0,
+            static_cast<unsigned long long>(fMaxLoopCycles / kCyclesPerUs));
+    fprintf(inStream, "interrupts disabled = %llu microseconds total, %llu microseconds longest\n",
+            static_cast<unsigned long long>(fDisabledCycles / kCyclesPerUs),
+            static_cast<unsigned long long>(fMaxDisabledCycles / kCyclesPerUs));
+    for (int i = 0; i < static_cast<int>(HostVector::Count); ++i) {
+      const VectorStats& aStats = fVectorStats[i];
+      if (!aStats.fCount && !aStats.fLost)
+        continue;
+      fprintf(inStream, "ISR %-13s count = %llu, lost = %llu, max entry latency = %.2f us, max run = %.2f us\n",
+              kVectorNames[i], static_cast<unsigned long long>(aStats.fCount),
+              static_cast<unsigned long long>(aStats.fLost), aStats.fMaxEntryCycles / static_cast<double>(kCyclesPerUs),
+              aStats.fMaxRunCycles / static_cast<double>(kCyclesPerUs));
+      if (fBudgetCycles && aStats.fMaxEntryCycles > fBudgetCycles) {
+        aPassed = false;
+      }
+    }
+    for (const WatchedQueue& aQueue : fQueues) {
+      const uint64_t aHandled = aQueue.fEvents - aQueue.fPushedAt.size();
+      const double aMeanUs = (aHandled ? aQueue.fTotalLatencyCycles / static_cast<double>(aHandled * kCyclesPerUs) : 0.0);
+      fprintf(inStream,
+              "queue %-19s events = %llu, handled = %llu, dropped = %u, late = %llu, max depth = %zu, "
+              "mean latency = %.1f us, max latency = %.1f us\n",
+              aQueue.fName.c_str(), static_cast<unsigned long long>(aQueue.fEvents),
+              static_cast<unsigned long long>(aHandled), static_cast<unsigned>(*aQueue.fDropped),
+              static_cast<unsigned long long>(aQueue.fLate), aQueue.fMaxDepth, aMeanUs,
+              aQueue.fMaxLatencyCycles / static_cast<double>(kCyclesPerUs));
+      if (*aQueue.fDropped || aQueue.fLate) {
+        aPassed = false;
+      }
+    }
+    for (const WatchedFlag& aFlag : fFlags) {
+      const double aMeanUs =
+          (aFlag.fHandled ? aFlag.fTotalLatencyCycles / static_cast<double>(aFlag.fHandled * kCyclesPerUs) : 0.0);
+      fprintf(inStream,
+              "flag %-20s events = %llu, handled = %llu, missed = %llu, late = %llu, mean latency = %.1f us, "
+              "max latency = %.1f us\n",
+              aFlag.fName.c_str(), static_cast<unsigned long long>(aFlag.fEvents),
+              static_cast<unsigned long long>(aFlag.fHandled), static_cast<unsigned long long>(aFlag.fMissed),
+              static_cast<unsigned long long>(aFlag.fLate), aMeanUs,
+              aFlag.fMaxLatencyCycles / static_cast<double>(kCyclesPerUs));
+      if (aFlag.fMissed || aFlag.fLate) {
+        aPassed = false;
+      }
+    }
+    if (fSleeps) {
+      fprintf(inStream,
+              "sleeps = %llu, asleep = %.1f%% of the time, Timer0 wakeups = %llu, missed wakeups = %llu, sleeps with "
+              "interrupts disabled = %llu\n",
+              static_cast<unsigned long long>(fSleeps), fNow ? 100.0 * fSleepCycles / fNow : 0.0,
+              static_cast<unsigned long long>(fTimer0Wakeups), static_cast<unsigned long long>(fMissedWakeups),
+              static_cast<unsigned long long>(fSleepsWithInterruptsDisabled));
+      if (fMissedWakeups || fSleepsWithInterruptsDisabled) {
+        aPassed = false;
+      }
+    }
+    fprintf(inStream, "%s (budget %llu microseconds)\n", aPassed ? "PASS" : "FAIL",
+            static_cast<unsigned long long>(fBudgetCycles / kCyclesPerUs));
+    return aPassed;
+  }
+
+  void SetLatencyBudgetUs(const uint64_t inUs) { fBudgetCycles = inUs * kCyclesPerUs; }
+
+  const VectorStats& Stats(const HostVector inVector) const { return fVectorStats[static_cast<int>(inVector)]; }
+
+  // State the HAL reads and writes directly
+  uint8_t fPinLevels[kPinCount] = {};
+  uint8_t fPinModes[kPinCount] = {};
+  uint16_t fAnalogValues[kPinCount] = {};
+  std::function<uint16_t(uint8_t)> fAnalogSource; // overrides fAnalogValues when set
+  std::vector<std::function<void(uint8_t, uint8_t)>> fPinChangeHooks; // e.g. sensor models watching a trigger
+  uint8_t fExternalPins[2] = {2, 3};
+  uint8_t fExternalModes[2] = {};
+  void (*fExternalHandlers[2])(void) = {};
+  bool fInIsr = false;
+  FILE* fSerialOut = nullptr; // receives every byte the sketch writes
+  uint64_t fSerialBaud = 9600;
+  uint64_t fSerialDrainedAt = 0; // cycle at which the UART has sent every queued byte
+  uint64_t fSerialBytes = 0;
+  uint64_t fSerialCycles = 0; // spent inside Serial writes, copying or blocked on a full TX ring
+  uint64_t fTimer1Restarts = 0;
+  uint64_t fLoopPasses = 0;
+  uint64_t fSleeps = 0;
+  uint64_t fWakeups = 0;
+  uint64_t fTimer0Wakeups = 0;
+  uint64_t fMissedWakeups = 0;
+  uint64_t fSleepsWithInterruptsDisabled = 0;
+  uint64_t fSleepCycles = 0;
+
+  // Registers the pin change and timer models read, bound by the HAL
+  const volatile uint8_t* fEimsk = NULL;
+  volatile uint8_t* fEifr = NULL; // flags live in fExternalFlags; the register only holds the bits written
+  const volatile uint8_t* fPcicr = NULL;
+  const volatile uint8_t* fPcmsk[3] = {};
+  const volatile uint8_t* fTccr1b = NULL;
+  const volatile uint8_t* fTimsk1 = NULL;
+  const volatile uint16_t* fOcr1[2] = {}; // OCR1A, OCR1B
+  volatile uint8_t* fTifr1 = NULL; // as EIFR
+  const volatile uint16_t* fTcnt1 = NULL;
+  const volatile uint8_t* fTimsk0 = NULL;
+  const volatile uint8_t* fOcr0[2] = {}; // OCR0A, OCR0B
+  const volatile uint8_t* fAdmux = NULL;
+  const volatile uint8_t* fAdcsrb = NULL;
+  volatile uint8_t* fAdcsra = NULL; // ADSC and ADIF are cleared by the hardware
+  uint64_t fAdcConversions = 0;
+
+  private:
+  void DispatchPending() {
+    while (fPending && fInterruptsEnabled && !fInIsr) {
+      int aIndex = 0;
+      while (!(fPending & (1u << aIndex))) {
+        aIndex++;
+      }
+      fPending &= ~(1u << aIndex);
+      VectorStats& aStats = fVectorStats[aIndex];
+      aStats.fCount++;
+      aStats.fMaxEntryCycles = std::max(aStats.fMaxEntryCycles, fNow - fRaisedAt[aIndex]);
+
+      std::vector<uint8_t> aBefore(fFlags.size());
+      for (std::size_t i = 0; i < fFlags.size(); ++i) {
+        aBefore[i] = *fFlags[i].fFlag;
+      }
+      const uint64_t aStart = fNow;
+      fIsrCount++;
+      fInIsr = true;
+      Advance(kIsrEntryCycles);
+      fIsrs[aIndex]();
+      fInIsr = false;
+      fIsrCycles += fNow - aStart;
+      aStats.fMaxRunCycles = std::max(aStats.fMaxRunCycles, fNow - aStart);
+
+      for (std::size_t i = 0; i < fFlags.size(); ++i) {
+        WatchedFlag& aFlag = fFlags[i];
+        if (static_cast<int>(aFlag.fVector) != aIndex || !*aFlag.fFlag || (aBefore[i] && !aFlag.fPending))
+          continue;
+        if (aBefore[i]) {
+          // The loop has not consumed the previous event yet, so this one is folded into it
+          aFlag.fMissed++;
+          continue;
+        }
+        aFlag.fEvents++;
+        aFlag.fPending = true;
+        aFlag.fSetAt = aStart;
+      }
+      for (WatchedQueue& aQueue : fQueues) {
+        for (; aQueue.fSeenHead != *aQueue.fHead; ++aQueue.fSeenHead) {
+          aQueue.fPushedAt.push_back(aStart);
+          aQueue.fEvents++;
+        }
+        aQueue.fMaxDepth = std::max(aQueue.fMaxDepth, aQueue.fPushedAt.size());
+      }
+    }
+  }
+
+  bool EventsPending() const {
+    for (const WatchedFlag& aFlag : fFlags) {
+      if (aFlag.fPending)
+        return true;
+    }
+    for (const WatchedQueue& aQueue : fQueues) {
+      if (!aQueue.fPushedAt.empty())
+        return true;
+    }
+    return false;
+  }
+
+  void CheckFlagsConsumed() {
+    for (WatchedQueue& aQueue : fQueues) {
+      for (; aQueue.fSeenTail != *aQueue.fTail && !aQueue.fPushedAt.empty(); ++aQueue.fSeenTail) {
+        const uint64_t aLatency = fNow - aQueue.fPushedAt.front();
+        aQueue.fPushedAt.pop_front();
+        aQueue.fTotalLatencyCycles += aLatency;
+        aQueue.fMaxLatencyCycles = std::max(aQueue.fMaxLatencyCycles, aLatency);
+        if (fBudgetCycles && aLatency > fBudgetCycles) {
+          aQueue.fLate++;
+        }
+      }
+    }
+    for (WatchedFlag& aFlag : fFlags) {
+      if (!aFlag.fPending || *aFlag.fFlag)
+        continue;
+      const uint64_t aLatency = fNow - aFlag.fSetAt;
+      aFlag.fPending = false;
+      aFlag.fHandled++;
+      aFlag.fTotalLatencyCycles += aLatency;
+      aFlag.fMaxLatencyCycles = std::max(aFlag.fMaxLatencyCycles, aLatency);
+      if (fBudgetCycles && aLatency > fBudgetCycles) {
+        aFlag.fLate++;
+      }
+    }
+  }
+
+  uint8_t PortLevels(const uint8_t inFirstPin, const uint8_t inPins) const {
+    uint8_t aValue = 0;
+    for (uint8_t i = 0; i < inPins; ++i) {
+      aValue |= (fPinLevels[inFirstPin + i] ? 1 : 0) << i;
+    }
+    return aValue;
+  }
+
+  // External interrupts -------------------------------------------------------------------------------------------
+
+  // Unmasking INT0/INT1 over a flagged edge raises it; masking it while it is pending leaves only the flag
+  void ExternalMaskWritten() {
+    for (int i = 0; i < 2; ++i) {
+      const HostVector aVector = (i == 0 ? HostVector::INT0_vect : HostVector::INT1_vect);
+      const uint32_t aPendingBit = 1u << static_cast<int>(aVector);
+      if (!(*fEimsk & (1 << i))) {
+        if (fPending & aPendingBit) {
+          fPending &= ~aPendingBit;
+          fExternalFlags |= (1 << i);
+        }
+      } else if (fExternalFlags & (1 << i)) {
+        fExternalFlags &= ~(1 << i);
+        RaiseVector(aVector);
+      }
+    }
+  }
+
+  // Timer1 ------------------------------------------------------------------------------------------------------
+
+  uint64_t Timer1Prescaler() const {
+    static const uint64_t kPrescalers[8] = {0, 1, 8, 64, 256, 1024, 0, 0};
+    return (fTccr1b ? kPrescalers[*fTccr1b & 0x07] : 0);
+  }
+
+  // CTC mode (WGM12) counts 0..OCR1A, normal mode 0..0xFFFF
+  uint64_t Timer1Top() const { return (*fTccr1b & (1 << 3)) ? *fOcr1[0] : 0xFFFF; }
+
+  uint16_t Timer1Count() const {
+    if (!fTimer1Prescaler)
+      return fTimer1Held;
+    return static_cast<uint16_t>(((fNow - fTimer1ZeroAt) / fTimer1Prescaler) % (Timer1Top() + 1));
+  }
+
+  // Channel A and B each match once per counter period, as the count passes OCR1A / OCR1B (in CTC mode
+  // channel A's match is the wrap to zero). Returns false when the channel never matches.
+  bool Timer1FirstMatch(const int inChannel, uint64_t& outAt, uint64_t& outPeriod) const {
+    const uint64_t aTop = Timer1Top();
+    const uint64_t aCompare = *fOcr1[inChannel];
+    if (!fTimer1Prescaler || aCompare > aTop)
+      return false;
+    outAt = fTimer1ZeroAt + (aCompare + 1) * fTimer1Prescaler;
+    outPeriod = (aTop + 1) * fTimer1Prescaler;
+    return true;
+  }
+
+  // A match sets the channel's TIFR1 flag whether or not its interrupt is enabled, and the ISR clears it
+  bool Timer1Flagged(const int inChannel) const {
+    uint64_t aAt, aPeriod;
+    if (!Timer1FirstMatch(inChannel, aAt, aPeriod) || fNow < aAt)
+      return false;
+    return aAt + (fNow - aAt) / aPeriod * aPeriod > fTimer1ClearedAt[inChannel];
+  }
+
+  bool Timer1Enabled(const int inChannel) const { return fTimsk1 && (*fTimsk1 & (2 << inChannel)); }
+
+  // Enabling a channel over a stale flag fires it at once, as on the AVR
+  void Timer1ControlWritten() {
+    for (int i = 0; i < 2; ++i) {
+      ScheduleTimer1(i);
+      if (Timer1Enabled(i) && Timer1Flagged(i)) {
+        fTimer1ClearedAt[i] = fNow;
+        RaiseVector(i ? HostVector::TIMER1_COMPB_vect : HostVector::TIMER1_COMPA_vect);
+      }
+    }
+  }
+
+  void ScheduleTimer1(const int inChannel) {
+    const uint64_t aGeneration = ++fTimer1Generation[inChannel];
+    uint64_t aAt, aPeriod;
+    if (!Timer1Enabled(inChannel) || !Timer1FirstMatch(inChannel, aAt, aPeriod))
+      return;
+    const uint64_t aNext = (fNow < aAt ? aAt : aAt + ((fNow - aAt) / aPeriod + 1) * aPeriod);
+    At(aNext, [this, inChannel, aGeneration]() {
+      if (aGeneration != fTimer1Generation[inChannel])
+        return;
+      fTimer1ClearedAt[inChannel] = fNow;
+      RaiseVector(inChannel ? HostVector::TIMER1_COMPB_vect : HostVector::TIMER1_COMPA_vect);
+      if (aGeneration == fTimer1Generation[inChannel]) {
+        ScheduleTimer1(inChannel);
+      }
+    });
+  }
+
+  // Timer0 ------------------------------------------------------------------------------------------------------
+
+  // Timer0 runs millis() from power-on: prescaler 64, overflowing every 1024 us. Its compare channels match
+  // once per period, as the count passes OCR0A / OCR0B, and are modelled only to raise their interrupts.
+  void ScheduleTimer0(const int inChannel) {
+    const uint64_t aGeneration = ++fTimer0Generation[inChannel];
+    if (!fTimsk0 || !(*fTimsk0 & (2 << inChannel)))
+      return;
+    uint64_t aNext = fNow / kTimer0OverflowCycles * kTimer0OverflowCycles + (*fOcr0[inChannel] + 1ULL) * 64;
+    if (aNext <= fNow) {
+      aNext += kTimer0OverflowCycles;
+    }
+    At(aNext, [this, inChannel, aGeneration]() {
+      if (aGeneration != fTimer0Generation[inChannel])
+        return;
+      RaiseVector(inChannel ? HostVector::TIMER0_COMPB_vect : HostVector::TIMER0_COMPA_vect);
+      if (aGeneration == fTimer0Generation[inChannel]) {
+        ScheduleTimer0(inChannel);
+      }
+    });
+  }
+
+  // ADC -------------------------------------------------------------------------------------------------------
+
+  // ADCSRA bits: ADEN 7, ADSC 6, ADATE 5, ADIF 4 (write one to clear), ADIE 3, ADPS2:0
+  void AdcControlWritten() {
+    if (*fAdcsra & (1 << 4)) {
+      *fAdcsra &= ~(1 << 4);
+    }
+    if (!(*fAdcsra & (1 << 7))) {
+      // Disabling the ADC aborts a conversion, and the next one is a first conversion again
+      *fAdcsra &= ~(1 << 6);
+      fAdcGeneration++;
+      fAdcConverting = false;
+      fAdcFirstDone = false;
+      return;
+    }
+    if ((*fAdcsra & (1 << 6)) && !fAdcConverting) {
+      ScheduleAdcConversion();
+    }
+  }
+
+  // 13 ADC clocks per conversion, 25 for the first one after enabling. The result is sampled at the end of
+  // the conversion from fAnalogSource / fAnalogValues of the ADMUX channel.
+  void ScheduleAdcConversion() {
+    static const uint64_t kAdcPrescalers[8] = {2, 2, 4, 8, 16, 32, 64, 128};
+    fAdcConverting = true;
+    const uint64_t aCycles = (fAdcFirstDone ? 13 : 25) * kAdcPrescalers[*fAdcsra & 0x07];
+    const uint64_t aGeneration = ++fAdcGeneration;
+    At(fNow + aCycles, [this, aGeneration]() {
+      if (aGeneration != fAdcGeneration)
+        return;
+      const uint8_t aPin = static_cast<uint8_t>(14 + (fAdmux ? (*fAdmux & 0x0F) : 0));
+      fAdcResult = (aPin < kPinCount ? (fAnalogSource ? fAnalogSource(aPin) : fAnalogValues[aPin]) : 0);
+      fAdcFirstDone = true;
+      fAdcConverting = false;
+      fAdcConversions++;
+      // Free running: auto trigger with ADTS2:0 = 0 starts the next conversion straight away
+      const bool aFreeRunning = (*fAdcsra & (1 << 5)) && (!fAdcsrb || !(*fAdcsrb & 0x07));
+      if (!aFreeRunning) {
+        *fAdcsra &= ~(1 << 6);
+      }
+      if (*fAdcsra & (1 << 3)) {
+        RaiseVector(HostVector::ADC_vect); // ADIF is cleared on ISR entry
+      } else {
+        *fAdcsra |= (1 << 4);
+      }
+      if (aFreeRunning && (*fAdcsra & (1 << 7)) && !fAdcConverting) {
+        ScheduleAdcConversion();
+      }
+    });
+  }
+
+  uint64_t fNow = 0;
+  uint64_t fSequence = 0;
+  std::priority_queue<SimEvent, std::vector<SimEvent>, std::greater<SimEvent>> fEvents;
+
+  void (*fIsrs[static_cast<int>(HostVector::Count)])(void) = {};
+  uint32_t fPending = 0;
+  uint64_t fRaisedAt[static_cast<int>(HostVector::Count)] = {};
+  VectorStats fVectorStats[static_cast<int>(HostVector::Count)];
+  uint64_t fIsrCycles = 0; // total time spent in ISRs
+  uint64_t fIsrCount = 0;
+  uint64_t fEnabledAt = 0;
+  bool fEnableRanIsrs = false;
+  bool fInterruptsEnabled = true;
+  uint64_t fDisabledAt = 0;
+  uint64_t fDisabledCycles = 0;
+  uint64_t fMaxDisabledCycles = 0;
+
+  std::vector<WatchedFlag> fFlags;
+  std::vector<WatchedQueue> fQueues;
+  uint64_t fBudgetCycles = 0;
+  uint64_t fLoopCycles = 0;
+  uint64_t fMaxLoopCycles = 0;
+
+  uint8_t fExternalFlags = 0; // EIFR: INTF0, INTF1
+  uint64_t fTimer1Prescaler = 0;
+  uint64_t fTimer1ZeroAt = 0;
+  uint16_t fTimer1Held = 0; // the count while stopped
+  uint64_t fTimer1ClearedAt[2] = {};
+  uint64_t fTimer1Generation[2] = {};
+  uint64_t fTimer0Generation[2] = {};
+  uint16_t fAdcResult = 0;
+  uint64_t fAdcGeneration = 0;
+  bool fAdcConverting = false;
+  bool fAdcFirstDone = false;
+} HostSimulator;
+
+// The one simulator instance the HAL functions and ISR registrations talk to
+inline HostSimulator& Sim() {
+  static HostSimulator aSimulator;
+  return aSimulator;
+}
+
+#endif // HOST_SIMULATOR_H
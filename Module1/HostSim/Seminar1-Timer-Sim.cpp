@@ -0,0 +1,61 @@
+#include <cstdlib>
+
+#include "ArduinoHostHAL.h"
+
+// Host simulation of Module2/M2.S2P/Seminar1-Timer.cpp. The potentiometer sits at a few fixed positions
+// with +-1 LSB of noise, as a real ADC reading does. Every restart of Timer1 beyond the real position
+// changes is a spurious reconfiguration that resets TCNT1 and glitches the LED. The report also shows how
+// long each filtered reading the ADC ISR publishes waits for loop().
+//
+// Usage: Seminar1-Timer-Sim.o [durationMs] [positionPeriodMs] [budgetUs] [-v]
+
+// Prototypes the Arduino IDE generates for the sketch
+struct Prescaler determinePrescaler(const double timerFrequencyHz);
+void startTimer(const double timerFrequency);
+void retuneTimer(const uint16_t potentioVal);
+void loadTimer(const uint16_t csRegisterValue, const uint16_t ticks);
+void startSampling();
+
+#include "../../Module2/M2.S2P/Seminar1-Timer.cpp"
+
+int main(int argc, char** argv) {
+  uint64_t aDurationMs = 2000;
+  uint64_t aPositionPeriodMs = 500;
+  uint64_t aBudgetUs = 1000;
+  if (argc > 1)
+    aDurationMs = strtoull(argv[1], NULL, 10);
+  if (argc > 2)
+    aPositionPeriodMs = strtoull(argv[2], NULL, 10);
+  if (argc > 3)
+    aBudgetUs = strtoull(argv[3], NULL, 10);
+
+  HostSimulator& aSim = Sim();
+  aSim.fSerialOut = (argc > 4 && !strcmp(argv[4], "-v") ? stdout : nullptr);
+  aSim.SetLatencyBudgetUs(aBudgetUs);
+  aSim.WatchFlag("potentiometerChanged", &potentiometerChanged, HostVector::ADC_vect);
+
+  static const uint16_t kPositions[] = {40, 300, 700, 1000};
+  uint32_t aNoise = 12345;
+  aSim.fAnalogSource = [&](uint8_t) {
+    const uint64_t aPosition = (aSim.NowUs() / 1000 / (aPositionPeriodMs ? aPositionPeriodMs : 1)) % 4;
+    aNoise = aNoise * 1103515245u + 12345u;
+    return static_cast<uint16_t>(kPositions[aPosition] + static_cast<int>((aNoise >> 16) % 3) - 1);
+  };
+  uint64_t aLedToggles = 0;
+  aSim.fPinChangeHooks.push_back([&](const uint8_t inPin, uint8_t) { aLedToggles += (inPin == LED_PIN); });
+
+  RunSketch(aDurationMs * 1000);
+  const uint64_t aPositionChanges = 1 + aDurationMs / (aPositionPeriodMs ? aPositionPeriodMs : 1);
+  printf("LED toggles = %llu, timer restarts = %llu, position changes = %llu, ADC conversions = %llu, serial bytes = %llu\n",
+         static_cast<unsigned long long>(aLedToggles), static_cast<unsigned long long>(aSim.fTimer1Restarts),
+         static_cast<unsigned long long>(aPositionChanges), static_cast<unsigned long long>(aSim.fAdcConversions),
+         static_cast<unsigned long long>(aSim.fSerialBytes));
+  const bool aPassed = aSim.Report(stdout);
+  // setup() starts the timer once more than there are position changes
+  const bool aSpurious = (aSim.fTimer1Restarts > aPositionChanges + 1);
+  if (aSpurious) {
+    printf("FAIL: %llu spurious timer restarts\n",
+           static_cast<unsigned long long>(aSim.fTimer1Restarts - aPositionChanges - 1));
+  }
+  return (aPassed && !aSpurious) ? 0 : 1;
+}
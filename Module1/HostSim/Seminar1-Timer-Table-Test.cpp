@@ -0,0 +1,42 @@
+#include <cstdlib>
+
+#include "ArduinoHostHAL.h"
+
+// Checks the precomputed Timer1 table of Module2/M2.S2P/Seminar1-Timer.cpp against the runtime formula it
+// replaced: for every potentiometer reading, determinePrescaler picks the prescaler and startTimer divides
+// the clock by prescaler * frequency. Reading 0 asks for 0 Hz, which the formula cannot express, and must
+// map to the slowest setting instead.
+//
+// Usage: Seminar1-Timer-Table-Test.o
+
+// Prototypes the Arduino IDE generates for the sketch
+struct Prescaler determinePrescaler(const double timerFrequencyHz);
+void startTimer(const double timerFrequency);
+void retuneTimer(const uint16_t potentioVal);
+void loadTimer(const uint16_t csRegisterValue, const uint16_t ticks);
+void startSampling();
+
+#include "../../Module2/M2.S2P/Seminar1-Timer.cpp"
+
+int main() {
+  uint32_t aMismatches = 0;
+  for (uint16_t aValue = 1; aValue < potentiometerSteps; ++aValue) {
+    const double aFrequency = (double)aValue / 4.0;
+    const Prescaler aPrescaler = determinePrescaler(aFrequency);
+    const unsigned short aTicks = (clockFrequencyHz / (aPrescaler.prescaler * aFrequency));
+    const uint8_t aTableCs = pgm_read_byte(&timerSettings[aValue].csRegisterValue);
+    const uint16_t aTableTicks = pgm_read_word(&timerSettings[aValue].ticks);
+    if (aTableCs != aPrescaler.csRegisterValue || aTableTicks != aTicks) {
+      printf("reading %u: table cs = 0x%02x, ticks = %u; formula cs = 0x%02x, ticks = %u\n", aValue, aTableCs,
+             aTableTicks, aPrescaler.csRegisterValue, aTicks);
+      aMismatches++;
+    }
+  }
+  const bool aZeroClamped = (pgm_read_byte(&timerSettings[0].csRegisterValue) == ((1 << CS10) | (1 << CS12)) &&
+                             pgm_read_word(&timerSettings[0].ticks) == 0xFFFF);
+  printf("table: %u readings, %u mismatches, reading 0 %s\n", potentiometerSteps, aMismatches,
+         aZeroClamped ? "clamped to the slowest setting" : "NOT CLAMPED");
+  const bool aPassed = (!aMismatches && aZeroClamped);
+  printf("%s\n", aPassed ? "PASS" : "FAIL");
+  return aPassed ? 0 : 1;
+}
@@ -0,0 +1,72 @@
+#include <cstdlib>
+
+#include "ArduinoHostHAL.h"
+#include "../IdleSleep.h"
+
+// Checks that Module1/IdleSleep.h never sleeps past a pending event. A test sketch sleeps between INT0
+// edges that arrive at pseudo-random intervals, so some land between loop()'s flag check and the sleep
+// instruction. For the first half of the run it sleeps through SleepUnless and no wakeup may be missed;
+// for the second half it checks the flag with interrupts enabled before sleeping, and the simulator must
+// catch the wakeups that race loses, which shows the check can fail.
+//
+// Usage: Sleep-Test.o [durationMs]
+
+static constexpr uint8_t edgePin = 2;
+static volatile uint8_t edgeSeen = 0;
+static bool racy = false;
+static uint64_t handled = 0;
+
+void OnEdge() {
+  edgeSeen = 1;
+}
+
+void setup() {
+  attachInterrupt(digitalPinToInterrupt(edgePin), OnEdge, CHANGE);
+}
+
+void loop() {
+  if (edgeSeen) {
+    edgeSeen = 0;
+    handled++;
+    digitalWrite(LED_BUILTIN, handled & 1);
+  }
+  if (!racy) {
+    SleepUnless([]() { return edgeSeen; });
+  } else if (!edgeSeen) {
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+    sleep_cpu();
+    sleep_disable();
+  }
+}
+
+int main(int argc, char** argv) {
+  uint64_t aDurationMs = 2000;
+  if (argc > 1)
+    aDurationMs = strtoull(argv[1], NULL, 10);
+
+  HostSimulator& aSim = Sim();
+  aSim.WatchFlag("edgeSeen", &edgeSeen, HostVector::INT0_vect);
+  uint32_t aSeed = 12345;
+  std::function<void()> aEdge = [&]() {
+    aSim.SetPinLevel(edgePin, !aSim.fPinLevels[edgePin]);
+    aSeed = aSeed * 1103515245u + 12345u;
+    aSim.At(aSim.Now() + 200 + (aSeed >> 16) % 1600, aEdge);
+  };
+  aSim.At(0, aEdge);
+
+  uint64_t aMissedSafe = 0;
+  aSim.AfterUs(aDurationMs * 500, [&]() {
+    aMissedSafe = aSim.fMissedWakeups;
+    racy = true;
+  });
+  RunSketch(aDurationMs * 1000);
+
+  const uint64_t aMissedRacy = aSim.fMissedWakeups - aMissedSafe;
+  printf("edges handled = %llu, sleeps = %llu, missed wakeups: SleepUnless = %llu, check then sleep = %llu\n",
+         static_cast<unsigned long long>(handled), static_cast<unsigned long long>(aSim.fSleeps),
+         static_cast<unsigned long long>(aMissedSafe), static_cast<unsigned long long>(aMissedRacy));
+  const bool aPassed = (!aMissedSafe && aMissedRacy && !aSim.fSleepsWithInterruptsDisabled);
+  printf("%s\n", aPassed ? "PASS" : "FAIL");
+  return aPassed ? 0 : 1;
+}
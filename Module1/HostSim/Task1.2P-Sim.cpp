@@ -0,0 +1,57 @@
+#include <cstdlib>
+
+#include "ArduinoHostHAL.h"
+#include "HostSensors.h"
+
+// Host simulation of Module1/Task1.2P.cpp. A push-button on the INT0 pin, pulled up and pressed to ground,
+// chatters on every press and release. The sketch toggles the LED once per release, so the LED must
+// change exactly as often as the button was released, and the report shows how many interrupts each
+// press cost.
+//
+// Usage: Task1.2P-Sim.o [durationMs] [pressPeriodMs] [holdMs] [budgetUs]
+
+#include "../Task1.2P.cpp"
+
+int main(int argc, char** argv) {
+  uint64_t aDurationMs = 2000;
+  uint64_t aPeriodMs = 400;
+  uint64_t aHoldMs = 150;
+  uint64_t aBudgetUs = 1000;
+  if (argc > 1)
+    aDurationMs = strtoull(argv[1], NULL, 10);
+  if (argc > 2)
+    aPeriodMs = strtoull(argv[2], NULL, 10);
+  if (argc > 3)
+    aHoldMs = strtoull(argv[3], NULL, 10);
+  if (argc > 4)
+    aBudgetUs = strtoull(argv[4], NULL, 10);
+
+  HostSimulator& aSim = Sim();
+  aSim.SetLatencyBudgetUs(aBudgetUs);
+  aSim.WatchFlag("buttonState", &buttonState, HostVector::TIMER1_COMPB_vect);
+
+  uint64_t aToggles = 0;
+  aSim.fPinChangeHooks.push_back([&aToggles](const uint8_t inPin, const uint8_t) {
+    if (inPin == LED_BUILTIN) {
+      aToggles++;
+    }
+  });
+  BouncingContact aButton(interruptPin);
+  const uint64_t aStartMs = 10;
+  aButton.PressEveryUs(LOW, aPeriodMs * 1000, aHoldMs * 1000, aStartMs * 1000);
+
+  RunSketch(aDurationMs * 1000);
+
+  // Releases that had 20 ms to settle and be handled before the end
+  uint64_t aReleases = 0;
+  for (uint64_t aPressMs = aStartMs; aPressMs + aHoldMs + 20 < aDurationMs; aPressMs += aPeriodMs) {
+    aReleases++;
+  }
+  const uint64_t aEntries = aSim.Stats(HostVector::INT0_vect).fCount + aSim.Stats(HostVector::TIMER1_COMPB_vect).fCount;
+  printf("presses = %llu, bounce edges = %llu, interrupts per press = %.1f, LED toggles = %llu (expected %llu)\n",
+         static_cast<unsigned long long>(aButton.fPresses), static_cast<unsigned long long>(aButton.fBounceEdges),
+         aButton.fPresses ? static_cast<double>(aEntries) / aButton.fPresses : 0.0,
+         static_cast<unsigned long long>(aToggles), static_cast<unsigned long long>(aReleases));
+  const bool aPassed = aSim.Report(stdout);
+  return (aPassed && aToggles == aReleases) ? 0 : 1;
+}
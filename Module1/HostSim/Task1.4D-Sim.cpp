@@ -0,0 +1,112 @@
+#include <cstdlib>
+
+#include "ArduinoHostHAL.h"
+#include "HostSensors.h"
+
+// Host simulation of Module1/Task1.4D.cpp. The tilt switch (bouncing on every change) and the four cluster
+// sensors toggle at fixed rates while the three ultrasonic sensors see an object sweeping 3-400 cm, one at
+// echoCm and one at 40 cm. The report shows how long the ISR events wait in the event ring for loop() and
+// whether any were dropped, and the ultrasonic throughput, which must beat 20 valid readings/s per sensor
+// (pings that timed out without an echo do not count) without a single echo lost to crosstalk, and the
+// scheduler's tasks, which must all meet their deadlines. A turn lasts as long as its echo, so the target
+// holds for the default echoCm, not for objects near the end of the range. The sketch's binary telemetry
+// can be captured for Telemetry-Decoder.o.
+//
+// Usage: Task1.4D-Sim.o [durationMs] [tiltPeriodUs] [clusterPeriodUs] [echoCm] [budgetUs] [capture]
+
+// Prototypes the Arduino IDE generates for the sketch
+struct SensorEvent;
+void HandleMotionDetected();
+void HandleTiltDetected();
+void ReleaseEventTasks();
+void HandleEvent(const SensorEvent& event);
+void HandleTelemetry();
+void HandleSchedulerReport();
+void HandlePing();
+void HandleEcho(const SensorEvent& event);
+void HandleRange();
+void HandleRead(const uint8_t sensor, const uint32_t durationUs);
+void HandleProximity(const uint8_t sensor, const unsigned short distanceCm);
+void HandleClusterTask();
+void HandleClusterSensors(const uint8_t port, const uint8_t states);
+
+#include "../Task1.4D.cpp"
+
+static const char* const kTaskNames[] = {"tilt", "ping", "range", "cluster", "motion", "telemetry", "report"};
+static_assert(sizeof(kTaskNames) / sizeof(kTaskNames[0]) == sketchTaskCount, "kTaskNames must name every task");
+
+int main(int argc, char** argv) {
+  uint64_t aDurationMs = 2000;
+  uint64_t aTiltPeriodUs = 100000;
+  uint64_t aClusterPeriodUs = 250000;
+  uint16_t aEchoCm = 250;
+  uint64_t aBudgetUs = 1000;
+  if (argc > 1)
+    aDurationMs = strtoull(argv[1], NULL, 10);
+  if (argc > 2)
+    aTiltPeriodUs = strtoull(argv[2], NULL, 10);
+  if (argc > 3)
+    aClusterPeriodUs = strtoull(argv[3], NULL, 10);
+  if (argc > 4)
+    aEchoCm = static_cast<uint16_t>(atoi(argv[4]));
+  if (argc > 5)
+    aBudgetUs = strtoull(argv[5], NULL, 10);
+
+  HostSimulator& aSim = Sim();
+  if (argc > 6 && !(aSim.fSerialOut = fopen(argv[6], "wb"))) {
+    fprintf(stderr, "cannot write %s\n", argv[6]);
+    return 1;
+  }
+  aSim.SetLatencyBudgetUs(aBudgetUs);
+  aSim.WatchQueue("sensorEvents", sensorEvents);
+
+  PingSensor aSweeping(ultrasonicPins[0], []() {
+    const uint64_t aPhaseMs = Sim().NowUs() / 1000 % 1000;
+    return static_cast<uint16_t>(3 + (aPhaseMs < 500 ? aPhaseMs : 1000 - aPhaseMs) * 397 / 500);
+  });
+  PingSensor aFixed(ultrasonicPins[1], [aEchoCm]() { return aEchoCm; });
+  PingSensor aNear(ultrasonicPins[2], []() { return static_cast<uint16_t>(40); });
+  static_assert(ultrasonicSensorCount == 3, "one sensor model per ultrasonic sensor");
+  BouncingContact aTilt(tiltPin);
+  aTilt.ToggleEveryUs(aTiltPeriodUs, 1000);
+  aSim.TogglePinEveryUs(pirSensorPin, 500000, 1000);
+  // Staggered so the cluster sensors do not all change in the same cycle
+  for (uint8_t i = 0; i < clusterSensorCount; ++i) {
+    aSim.TogglePinEveryUs(clusterSensors[i].pin, aClusterPeriodUs + i * 1000, 1500 + i * 250);
+  }
+
+  RunSketch(aDurationMs * 1000);
+  if (aSim.fSerialOut) {
+    fclose(aSim.fSerialOut);
+  }
+  printf("serial bytes = %llu, serial time = %llu us, telemetry dropped = %u\n",
+         static_cast<unsigned long long>(aSim.fSerialBytes),
+         static_cast<unsigned long long>(aSim.fSerialCycles / kCyclesPerUs), telemetry.fFrames.Dropped());
+  uint64_t aReadings = 0;
+  uint64_t aCrosstalk = 0;
+  for (const PingSensor* aSensor : PingSensor::Sensors()) {
+    printf("ultrasonic D%d: pings = %llu, readings = %llu, no echo = %llu, crosstalk = %llu\n", aSensor->fPin,
+           static_cast<unsigned long long>(aSensor->fPings), static_cast<unsigned long long>(aSensor->fReadings),
+           static_cast<unsigned long long>(aSensor->fNoEchoes), static_cast<unsigned long long>(aSensor->fCrosstalk));
+    aReadings += aSensor->fReadings;
+    aCrosstalk += aSensor->fCrosstalk;
+  }
+  const double aRate = aDurationMs ? aReadings * 1000.0 / aDurationMs : 0.0;
+  printf("ultrasonic readings = %.1f/s (one sensor at 20 Hz each: %d/s), crosstalk = %llu\n", aRate,
+         20 * ultrasonicSensorCount, static_cast<unsigned long long>(aCrosstalk));
+  const uint64_t aTiltEntries =
+    aSim.Stats(HostVector::INT0_vect).fCount + aSim.Stats(HostVector::TIMER1_COMPB_vect).fCount;
+  printf("tilt changes = %llu, bounce edges = %llu, interrupts per tilt change = %.1f\n",
+         static_cast<unsigned long long>(aTilt.fChanges), static_cast<unsigned long long>(aTilt.fBounceEdges),
+         aTilt.fChanges ? static_cast<double>(aTiltEntries) / aTilt.fChanges : 0.0);
+  uint32_t aMisses = 0;
+  for (uint8_t i = 0; i < sketchTaskCount; ++i) {
+    const TaskStats& aStats = scheduler.fStats[i];
+    printf("task %-9s runs = %lu, worst run = %lu us, worst response = %u ticks (deadline %u), missed = %u\n",
+           kTaskNames[i], static_cast<unsigned long>(aStats.fRuns), static_cast<unsigned long>(aStats.fWorstUs),
+           aStats.fWorstTicks, sketchTasks[i].fDeadlineTicks, aStats.fMisses);
+    aMisses += aStats.fMisses;
+  }
+  const bool aPassed = aSim.Report(stdout);
+  return (aPassed && !aCrosstalk && aRate > 20 * ultrasonicSensorCount && !aMisses) ? 0 : 1;
+}
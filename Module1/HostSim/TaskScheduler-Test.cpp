@@ -0,0 +1,129 @@
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "../TaskScheduler.h"
+
+// Checks Module1/TaskScheduler.h on the host against a fake clock: a tick every 1024 us, as Timer0's compare
+// channel B gives Task1.4D, and tasks that spend a set time when they run. Covers the earliest-deadline-first
+// order (an alarm overtakes logging released before it), the periodic releases, the deadline misses and
+// worst-case execution times recorded, and a run long enough to wrap the 16-bit tick clock.
+//
+// Usage: TaskScheduler-Test.o [ticks]
+
+static constexpr uint32_t tickUs = 1024;
+
+static uint32_t nowUs = 0;
+static void (*tick)(void) = nullptr;
+static std::vector<int> order; // the tasks in the order they ran
+static uint32_t costUs[3] = {0};
+
+static uint32_t FakeMicros() {
+  return nowUs;
+}
+
+// Moves the fake clock on, ticking the scheduler whenever a tick period is crossed
+static void Spend(const uint32_t us) {
+  for (uint32_t i = 0; i < us; ++i) {
+    if (++nowUs % tickUs == 0) {
+      tick();
+    }
+  }
+}
+
+template <int Task>
+void RunTask() {
+  order.push_back(Task);
+  Spend(costUs[Task]);
+}
+
+template <uint8_t Count>
+static void Reset(TaskScheduler<Count>& scheduler, const uint32_t cost0, const uint32_t cost1, const uint32_t cost2) {
+  static TaskScheduler<Count>* active = nullptr;
+  active = &scheduler;
+  tick = []() { active->Tick(); };
+  nowUs = 0;
+  order.clear();
+  costUs[0] = cost0;
+  costUs[1] = cost1;
+  costUs[2] = cost2;
+}
+
+// Logging released first, then an alarm: the alarm's deadline is earlier, so it runs first
+bool EarliestDeadlineFirst() {
+  static const TaskSpec tasks[] = {{RunTask<0>, 0, 2}, {RunTask<1>, 0, 20}, {RunTask<2>, 0, 5}};
+  TaskScheduler<3> scheduler(tasks);
+  Reset(scheduler, 100, 100, 100);
+  scheduler.Post(1);
+  scheduler.Post(2);
+  scheduler.Post(0);
+  scheduler.Post(0); // folded into the waiting release
+  while (scheduler.RunNext(FakeMicros)) {
+  }
+  const bool ok = order == std::vector<int>({0, 2, 1}) && scheduler.fStats[0].fRuns == 1 &&
+                  scheduler.fStats[0].fWorstUs == 100 && !scheduler.Pending();
+  printf("earliest deadline first: %s\n", ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// Deadlines count from the release: an alarm queued while a long task runs is released after it and still
+// meets its own, but an alarm running past its deadline misses it
+bool DeadlineMiss() {
+  static const TaskSpec tasks[] = {{RunTask<0>, 0, 1}, {RunTask<1>, 0, 20}};
+  TaskScheduler<2> scheduler(tasks);
+  Reset(scheduler, 50, 3 * tickUs, 0);
+  scheduler.Post(1);
+  bool ok = scheduler.RunNext(FakeMicros);
+  scheduler.Post(0); // as if the alarm's event had been queued during task 1
+  ok &= scheduler.RunNext(FakeMicros) && !scheduler.RunNext(FakeMicros);
+  ok &= !scheduler.fStats[0].fMisses && !scheduler.fStats[1].fMisses && scheduler.fStats[1].fWorstUs == 3 * tickUs;
+
+  scheduler.Post(1);
+  scheduler.Post(0);
+  costUs[0] = 2 * tickUs;
+  ok &= scheduler.RunNext(FakeMicros) && scheduler.RunNext(FakeMicros);
+  ok &= scheduler.fStats[0].fMisses == 1 && scheduler.fStats[0].fWorstTicks == 2 &&
+        scheduler.fStats[0].fWorstUs == 2 * tickUs;
+  printf("deadline miss: %s\n", ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// Periodic tasks released every period from tick 0 on, across the wrap of the 16-bit tick clock, with an
+// idle loop() that only looks every few ticks as a sleeping one would
+bool Periodic(const uint32_t ticks) {
+  static const TaskSpec tasks[] = {{RunTask<0>, 5, 5}, {RunTask<1>, 7, 3}, {RunTask<2>, 1000, 100}};
+  TaskScheduler<3> scheduler(tasks);
+  Reset(scheduler, 30, 200, 900);
+  while (nowUs / tickUs < ticks) {
+    while (scheduler.RunNext(FakeMicros)) {
+    }
+    Spend(3 * tickUs / 2);
+  }
+  // Releases up to and including the last tick passed
+  const uint32_t aLast = nowUs / tickUs;
+  const uint32_t aReleases[3] = {aLast / 5 + 1, aLast / 7 + 1, aLast / 1000 + 1};
+  while (scheduler.RunNext(FakeMicros)) {
+  }
+  bool ok = true;
+  for (int i = 0; i < 3; ++i) {
+    const TaskStats& aStats = scheduler.fStats[i];
+    printf("  task %d: runs = %lu (expected %lu), worst run = %lu us, worst response = %u ticks, missed = %u\n", i,
+           static_cast<unsigned long>(aStats.fRuns), static_cast<unsigned long>(aReleases[i]),
+           static_cast<unsigned long>(aStats.fWorstUs), aStats.fWorstTicks, aStats.fMisses);
+    ok &= aStats.fRuns == aReleases[i] && aStats.fWorstUs == costUs[i] && !aStats.fMisses;
+  }
+  printf("periodic over %lu ticks: %s\n", static_cast<unsigned long>(aLast), ok ? "ok" : "FAIL");
+  return ok;
+}
+
+int main(int argc, char** argv) {
+  uint32_t ticks = 200000;
+  if (argc > 1)
+    ticks = strtoul(argv[1], NULL, 10);
+
+  bool ok = EarliestDeadlineFirst();
+  ok &= DeadlineMiss();
+  ok &= Periodic(ticks);
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "../Telemetry.h"
+
+// Turns the binary telemetry of the Module1 sketches (see Module1/Telemetry.h) back into the log lines they
+// used to print, or into CSV. Reads a capture file, or stdin for "-", e.g. a serial port set up with
+// `stty -F /dev/ttyACM0 115200 raw` or the capture written by the simulations.
+//
+// Frames are found by their sync byte and CRC, so bytes before the first frame (a reset mid-stream, the
+// bootloader) are skipped. Timestamps are unwrapped past the 32-bit micros() rollover every 71 minutes; a
+// telemetryDropped frame carries the time of the latest drop and may be later than the frames after it.
+// Exits non-zero when bytes had to be skipped after the first frame, i.e. the stream was corrupted.
+//
+// Usage: Telemetry-Decoder.o [capture|-] [--csv]
+
+static const char* const kEventNames[] = {"start",          "dropped", "motion", "tilt",      "distance",
+                                          "cluster_motion", "button",  "bounce", "ping_rate", "deadline_miss",
+                                          "task_wcet"};
+static_assert(sizeof(kEventNames) / sizeof(kEventNames[0]) == telemetryEventCount,
+              "kEventNames must name every TelemetryEvent");
+
+static void PrintLine(const TelemetryFrame& inFrame, const unsigned long long inTimeUs) {
+  printf("[%12.3f ms] ", inTimeUs / 1000.0);
+  switch (inFrame.fEvent) {
+    case telemetryStart:
+      printf("Telemetry started (version %d)\n", inFrame.fValue);
+      break;
+    case telemetryDropped:
+      printf("%d frames dropped\n", inFrame.fValue);
+      break;
+    case telemetryMotion:
+      printf("Motion detected!\n");
+      break;
+    case telemetryTilt:
+      printf("Tilt Detected!\n");
+      break;
+    case telemetryDistance:
+      printf("%d cm (sensor %d)\n", inFrame.fValue, inFrame.fSensor);
+      break;
+    case telemetryClusterMotion:
+      printf("Motion detected on sensor %d\n", inFrame.fSensor + 1);
+      break;
+    case telemetryButton:
+      printf("Changing LED state! (LED %s)\n", inFrame.fValue ? "on" : "off");
+      break;
+    case telemetryBounce:
+      printf("Button bounced without changing state\n");
+      break;
+    case telemetryPingRate:
+      printf("%d ultrasonic readings/s\n", inFrame.fValue);
+      break;
+    case telemetryDeadlineMiss:
+      printf("Task %d missed %d deadlines\n", inFrame.fSensor, inFrame.fValue);
+      break;
+    case telemetryTaskWcet:
+      printf("Task %d worst-case execution time %d us\n", inFrame.fSensor, inFrame.fValue);
+      break;
+    default:
+      printf("unknown event %d, sensor %d, value %d\n", inFrame.fEvent, inFrame.fSensor, inFrame.fValue);
+      break;
+  }
+}
+
+int main(int argc, char** argv) {
+  const char* aPath = (argc > 1 ? argv[1] : "-");
+  const bool aCsv = (argc > 2 && !strcmp(argv[2], "--csv"));
+  FILE* aInput = (strcmp(aPath, "-") ? fopen(aPath, "rb") : stdin);
+  if (!aInput) {
+    fprintf(stderr, "cannot open %s\n", aPath);
+    return 1;
+  }
+
+  std::vector<uint8_t> aBytes;
+  uint8_t aChunk[4096];
+  size_t aRead;
+  while ((aRead = fread(aChunk, 1, sizeof(aChunk), aInput)) > 0) {
+    aBytes.insert(aBytes.end(), aChunk, aChunk + aRead);
+  }
+  if (aInput != stdin) {
+    fclose(aInput);
+  }
+
+  if (aCsv) {
+    printf("time_us,event,sensor,value\n");
+  }
+  unsigned long long aFrames = 0;
+  unsigned long long aLeading = 0;
+  unsigned long long aSkipped = 0;
+  unsigned long long aEpochUs = 0;
+  uint32_t aLastUs = 0;
+  size_t aAt = 0;
+  while (aAt + telemetryFrameBytes <= aBytes.size()) {
+    TelemetryFrame aFrame;
+    if (!DecodeTelemetryFrame(&aBytes[aAt], aFrame)) {
+      (aFrames ? aSkipped : aLeading)++;
+      aAt++;
+      continue;
+    }
+    aAt += telemetryFrameBytes;
+    if (aFrame.fEvent == telemetryStart) {
+      aEpochUs = 0;
+    } else if (aFrames && aFrame.fTimeUs < aLastUs && aLastUs - aFrame.fTimeUs > 0x80000000u) {
+      aEpochUs += 1ULL << 32;
+    }
+    aLastUs = aFrame.fTimeUs;
+    aFrames++;
+
+    const unsigned long long aTimeUs = aEpochUs + aFrame.fTimeUs;
+    if (aCsv) {
+      printf("%llu,%s,%d,%d\n", aTimeUs,
+             aFrame.fEvent < telemetryEventCount ? kEventNames[aFrame.fEvent] : "unknown", aFrame.fSensor,
+             aFrame.fValue);
+    } else {
+      PrintLine(aFrame, aTimeUs);
+    }
+  }
+
+  // A partial frame at the end is corrupt too, unless nothing decoded at all
+  (aFrames ? aSkipped : aLeading) += aBytes.size() - aAt;
+  fprintf(stderr, "frames = %llu, bytes = %zu, leading bytes skipped = %llu, corrupt bytes skipped = %llu\n",
+          aFrames, aBytes.size(), aLeading, aSkipped);
+  return aSkipped ? 1 : 0;
+}
@@ -0,0 +1,51 @@
+#include <cstdlib>
+
+#include "ArduinoHostHAL.h"
+#include "HostSensors.h"
+
+// Host simulation of Module1/Timer_Interrupted-Ultrasonic_Sensor.cpp: the object moves between the minimum
+// and maximum range and the report shows how long each Timer1 ping request and each timed echo wait for loop().
+// The sketch's binary telemetry can be captured for Telemetry-Decoder.o.
+//
+// Usage: Ultrasonic-Sim.o [durationMs] [budgetUs] [capture]
+
+// Prototypes the Arduino IDE generates for the sketch
+void EchoEdge();
+void HandleRead(const unsigned long durationUs);
+void HandleProximity(const unsigned short distanceCm);
+
+#include "../Timer_Interrupted-Ultrasonic_Sensor.cpp"
+
+int main(int argc, char** argv) {
+  uint64_t aDurationMs = 2000;
+  uint64_t aBudgetUs = 1000;
+  if (argc > 1)
+    aDurationMs = strtoull(argv[1], NULL, 10);
+  if (argc > 2)
+    aBudgetUs = strtoull(argv[2], NULL, 10);
+
+  HostSimulator& aSim = Sim();
+  if (argc > 3 && !(aSim.fSerialOut = fopen(argv[3], "wb"))) {
+    fprintf(stderr, "cannot write %s\n", argv[3]);
+    return 1;
+  }
+  aSim.SetLatencyBudgetUs(aBudgetUs);
+  aSim.WatchFlag("DoPing", &DoPing, HostVector::TIMER1_COMPA_vect);
+  aSim.WatchFlag("EchoReady", &EchoReady, HostVector::INT0_vect);
+
+  // Sweeps 3 cm -> 400 cm and back once per second
+  PingSensor aPing(SIGNAL_PIN, []() {
+    const uint64_t aPhaseMs = Sim().NowUs() / 1000 % 1000;
+    const uint64_t aSweepMs = (aPhaseMs < 500 ? aPhaseMs : 1000 - aPhaseMs);
+    return static_cast<uint16_t>(MIN_PROXIMITY_CM + aSweepMs * (MAX_PROXIMITY_CM - MIN_PROXIMITY_CM) / 500);
+  });
+
+  RunSketch(aDurationMs * 1000);
+  if (aSim.fSerialOut) {
+    fclose(aSim.fSerialOut);
+  }
+  printf("pings = %llu, serial bytes = %llu, serial time = %llu us, telemetry dropped = %u\n",
+         static_cast<unsigned long long>(aPing.fPings), static_cast<unsigned long long>(aSim.fSerialBytes),
+         static_cast<unsigned long long>(aSim.fSerialCycles / kCyclesPerUs), Telemetry.fFrames.Dropped());
+  return aSim.Report(stdout) ? 0 : 1;
+}
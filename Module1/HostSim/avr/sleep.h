@@ -0,0 +1,2 @@
+// Stands in for avr-libc's <avr/sleep.h> when a sketch is compiled for the host (compile.sh adds -I.)
+#include "../ArduinoHostHAL.h"
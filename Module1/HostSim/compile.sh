@@ -0,0 +1,11 @@
+#!/bin/bash
+
+g++ Task1.2P-Sim.cpp --std=c++17 -O2 -I. -o task1.2p_sim.o
+g++ Task1.4D-Sim.cpp --std=c++17 -O2 -I. -o task1.4d_sim.o
+g++ Ultrasonic-Sim.cpp --std=c++17 -O2 -I. -o ultrasonic_sim.o
+g++ Seminar1-Timer-Sim.cpp --std=c++17 -O2 -I. -o seminar1_timer_sim.o
+g++ Seminar1-Timer-Table-Test.cpp --std=c++17 -O2 -I. -o seminar1_timer_table_test.o
+g++ Sleep-Test.cpp --std=c++17 -O2 -I. -o sleep_test.o
+g++ Telemetry-Decoder.cpp --std=c++17 -O2 -o telemetry_decoder.o
+g++ EventRing-Test.cpp --std=c++17 -O2 -pthread -o eventring_test.o
+g++ TaskScheduler-Test.cpp --std=c++17 -O2 -o taskscheduler_test.o
@@ -0,0 +1,16 @@
+#!/bin/bash
+
+# Exits non-zero when any simulation misses an event or exceeds its latency budget, for use in CI
+./compile.sh
+STATUS=0
+./eventring_test.o >> eventring_test.log || STATUS=1
+./taskscheduler_test.o >> taskscheduler_test.log || STATUS=1
+./sleep_test.o >> sleep_test.log || STATUS=1
+./task1.2p_sim.o 5000 400 150 1000 >> task1.2p_sim.log || STATUS=1
+./task1.4d_sim.o 5000 100000 250000 250 1000 task1.4d_sim.bin >> task1.4d_sim.log || STATUS=1
+./telemetry_decoder.o task1.4d_sim.bin > task1.4d_sim.txt 2>> task1.4d_sim.log || STATUS=1
+./ultrasonic_sim.o 5000 1000 ultrasonic_sim.bin >> ultrasonic_sim.log || STATUS=1
+./telemetry_decoder.o ultrasonic_sim.bin > ultrasonic_sim.txt 2>> ultrasonic_sim.log || STATUS=1
+./seminar1_timer_table_test.o >> seminar1_timer_table_test.log || STATUS=1
+./seminar1_timer_sim.o 5000 >> seminar1_timer_sim.log || STATUS=1
+exit ${STATUS}
@@ -0,0 +1,28 @@
+#ifndef IDLE_SLEEP_H
+#define IDLE_SLEEP_H
+
+#include <avr/sleep.h>
+
+// Idles the CPU until the next interrupt unless inPending() reports work for loop(). Every event of the
+// interrupt-driven sketches arrives by an ISR, so loop() only needs to run after one has, and Timer0's
+// millis() overflow still wakes it every 1024 us for the timeouts it checks.
+//
+// The check runs with interrupts disabled and the sleep follows sei directly: sei takes effect after the next
+// instruction, so an ISR that becomes pending after the check runs once the CPU is asleep and wakes it,
+// instead of being left for an unrelated interrupt. Idle is the deepest mode these sketches allow: power-save
+// and power-down stop Timer0/Timer1, the UART and the INT0/INT1 edge detection (those wake on a low level only).
+template <typename Pending>
+inline void SleepUnless(const Pending& inPending) {
+  cli();
+  if (inPending()) {
+    sei();
+    return;
+  }
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  sleep_enable();
+  sei();
+  sleep_cpu();
+  sleep_disable();
+}
+
+#endif // IDLE_SLEEP_H
@@ -1,10 +1,15 @@
 // https://www.arduino.cc/reference/en/language/functions/external-interrupts/attachinterrupt/
 // https://www.instructables.com/Arduino-Timer-Interrupts/
 
+#include "Telemetry.h"
+
 constexpr unsigned char SIGNAL_PIN = 2;
 constexpr unsigned short MAX_PROXIMITY_CM = 400;
 constexpr unsigned short MIN_PROXIMITY_CM = 3;
 
+// Distances go out as binary frames (see Telemetry.h)
+static TelemetryLink<8> Telemetry;
+
 void ResetPingState()
 {
   pinMode(SIGNAL_PIN, OUTPUT);
@@ -32,8 +37,7 @@ void HandleProximity(const unsigned short distanceCm)
   if (distanceCm <= MAX_PROXIMITY_CM && distanceCm >= MIN_PROXIMITY_CM)
   {
     digitalWrite(LED_BUILTIN, HIGH);
-    Serial.print(distanceCm);
-    Serial.println(" cm");
+    Telemetry.Post(telemetryDistance, 0, distanceCm, micros());
   }
   else
   {
@@ -43,7 +47,8 @@ void HandleProximity(const unsigned short distanceCm)
 
 void setup()
 {
-  Serial.begin(9600);
+  Serial.begin(telemetryBaud);
+  Telemetry.Post(telemetryStart, 0, telemetryVersion, micros());
   pinMode(LED_BUILTIN, OUTPUT);
 }
 
@@ -52,5 +57,6 @@ void loop()
   ResetPingState();
   // References: https://docs.arduino.cc/built-in-examples/sensors/Ping
   DoRead();
+  Telemetry.Pump(Serial);
   delay(100);
 }
\ No newline at end of file
@@ -2,41 +2,59 @@
 
 // https://www.arduino.cc/reference/en/language/functions/external-interrupts/attachinterrupt/
 
+#include "Debounce.h"
+#include "IdleSleep.h"
+#include "Telemetry.h"
+
 static constexpr uint8_t interruptPin = 2;
-static constexpr uint16_t debounceMs = 1000;
 
+// The button is debounced in its ISRs (see Debounce.h): it must stay still for 10 ms, and the LED toggles
+// once per settled release, where the RISING edge toggled it once per bounce
+static DebouncedInput<0, 10> button;
 static volatile uint8_t ledState = 0;
 static volatile uint8_t buttonState = 0;
-static uint32_t lastButtonPressMs = 0;
+static volatile uint8_t buttonGlitched = 0;
+
+// Logging goes out as binary frames (see Telemetry.h), posted by loop() only
+static TelemetryLink<8> telemetry;
 
 void changeState(void) {
-  ledState = !ledState;
-  buttonState = 1;
+  button.PinChanged();
+}
+
+ISR(TIMER1_COMPB_vect)
+{
+  if (button.Sample() == debounceGlitch) {
+    buttonGlitched = 1;
+  } else if (button.fLevel) {
+    ledState = !ledState;
+    buttonState = 1;
+  }
 }
 
 void setup()
 {
   noInterrupts();
-  attachInterrupt(digitalPinToInterrupt(interruptPin), changeState, RISING);
   pinMode(interruptPin, INPUT_PULLUP);
+  button.Begin();
+  attachInterrupt(digitalPinToInterrupt(interruptPin), changeState, CHANGE);
   pinMode(LED_BUILTIN, OUTPUT);
-  Serial.begin(9600);
+  Serial.begin(telemetryBaud);
+  telemetry.Post(telemetryStart, 0, telemetryVersion, micros());
   interrupts();
 }
 
 void loop()
 {
   if (buttonState) {
-    if ((millis() - lastButtonPressMs) > debounceMs) {
-      digitalWrite(LED_BUILTIN, ledState);
-      lastButtonPressMs = millis();
-      Serial.println("Changing LED state!");
-      Serial.print("Last button press = ");
-      Serial.print(lastButtonPressMs);
-      Serial.println("ms");
-    } else {
-      Serial.println("Button state changed within debounce period!");
-    }
+    digitalWrite(LED_BUILTIN, ledState);
+    telemetry.Post(telemetryButton, 0, ledState, micros());
     buttonState = 0;
   }
+  if (buttonGlitched) {
+    telemetry.Post(telemetryBounce, 0, 0, micros());
+    buttonGlitched = 0;
+  }
+  telemetry.Pump(Serial);
+  SleepUnless([]() { return buttonState || buttonGlitched || telemetry.fFrames.Size(); });
 }
\ No newline at end of file
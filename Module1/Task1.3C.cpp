@@ -2,33 +2,51 @@
 
 // https://www.arduino.cc/reference/en/language/functions/external-interrupts/attachinterrupt/
 
+#include "Debounce.h"
+#include "IdleSleep.h"
+#include "Telemetry.h"
+
 static constexpr uint8_t pirSensorPin = 3;
 static volatile uint8_t motionDetected = 0;
 static constexpr uint16_t motionTimeoutMs = 2000;
 static uint32_t lastMotionDetectionMs = 0;
 
 static constexpr uint8_t tiltPin = 2;
+// Debounced in its ISRs (see Debounce.h), so a rattling tilt switch sounds the piezo once per settled change
+static DebouncedInput<0, 20> tiltSwitch;
 static volatile uint8_t tiltDetected = 0;
 static constexpr uint8_t piezoPin = 7;
 
+// Logging goes out as binary frames (see Telemetry.h), posted by loop() only
+static TelemetryLink<8> telemetry;
+
 void changeMotionDetectedState(void) {
   motionDetected = digitalRead(pirSensorPin);
 }
 
 void changeTiltState(void) {
-  tiltDetected = 1;
+  tiltSwitch.PinChanged();
+}
+
+ISR(TIMER1_COMPB_vect)
+{
+  if (tiltSwitch.Sample() == debounceChanged) {
+    tiltDetected = 1;
+  }
 }
 
 void setup()
 {
   noInterrupts();
-  attachInterrupt(digitalPinToInterrupt(tiltPin), changeTiltState, CHANGE);
   attachInterrupt(digitalPinToInterrupt(pirSensorPin), changeMotionDetectedState, CHANGE);
   pinMode(pirSensorPin, INPUT);
   pinMode(tiltPin, INPUT);
+  tiltSwitch.Begin();
+  attachInterrupt(digitalPinToInterrupt(tiltPin), changeTiltState, CHANGE);
   pinMode(piezoPin, OUTPUT);
   pinMode(LED_BUILTIN, OUTPUT);
-  Serial.begin(9600);
+  Serial.begin(telemetryBaud);
+  telemetry.Post(telemetryStart, 0, telemetryVersion, micros());
   interrupts();
 }
 
@@ -36,6 +54,8 @@ void loop()
 {
   HandleMotionDetected();
   HandleTiltDetected();
+  telemetry.Pump(Serial);
+  SleepUnless([]() { return tiltDetected || telemetry.fFrames.Size(); });
 }
 
 void HandleMotionDetected() {
@@ -43,10 +63,7 @@ void HandleMotionDetected() {
     if ((millis() - lastMotionDetectionMs) > motionTimeoutMs) {
       digitalWrite(LED_BUILTIN, HIGH);
       lastMotionDetectionMs = millis();
-      Serial.println("Motion detected!");
-      Serial.print("Last detection time = ");
-      Serial.print(lastMotionDetectionMs);
-      Serial.println("ms");
+      telemetry.Post(telemetryMotion, 0, 1, micros());
     }
   } else {
     digitalWrite(LED_BUILTIN, LOW);
@@ -55,7 +72,7 @@ void HandleMotionDetected() {
 
 void HandleTiltDetected() {
   if (tiltDetected) {
-    Serial.println("Tilt Detected!");
+    telemetry.Post(telemetryTilt, 0, 0, micros());
     tone(piezoPin, 494, 5);
     tiltDetected = 0;
   }
@@ -3,99 +3,307 @@
 // https://www.arduino.cc/reference/en/language/functions/external-interrupts/attachinterrupt/
 // https://www.electrosoftcloud.com/en/pcint-interrupts-on-arduino/
 
+#include "Debounce.h"
+#include "EventRing.h"
+#include "IdleSleep.h"
+#include "TaskScheduler.h"
+#include "Telemetry.h"
+
 struct RGB {
   uint8_t red;
   uint8_t green;
   uint8_t blue;
   RGB() = default;
-  RGB(uint8_t inRed, uint8_t inGreen, uint8_t inBlue) : red(inRed), green(inGreen), blue(inBlue) {}
+  constexpr RGB(uint8_t inRed, uint8_t inGreen, uint8_t inBlue) : red(inRed), green(inGreen), blue(inBlue) {}
 };
 
+// Every ISR posts a timestamped event and loop() drains them in order, so bursts of pin changes between two
+// passes of loop() are queued rather than coalesced into one flag. 32 events absorb e.g. every cluster
+// sensor toggling four times between passes. Cluster events carry their PCINT port in the source:
+// clusterEvent + port.
+enum EventSource : uint8_t { motionEvent, tiltEvent, pingEvent, echoEvent, clusterEvent };
+
+typedef struct SensorEvent {
+  uint8_t source;
+  uint8_t pins; // level(s) of the source's pin(s) when the event fired
+  uint32_t timeUs;
+} SensorEvent;
+
+static constexpr uint8_t sensorEventCapacity = 32;
+static EventRing<SensorEvent, sensorEventCapacity> sensorEvents;
+
+// Logging goes out as binary frames (see Telemetry.h), posted by loop() only
+static TelemetryLink<16> telemetry;
+
 static constexpr uint8_t pirSensorPin = 3;
-static volatile uint8_t motionDetected = 0;
+static uint8_t motionDetected = 0;
 static constexpr uint16_t motionTimeoutMs = 2000;
 static uint32_t lastMotionDetectionMs = 0;
 
-static constexpr uint8_t clusterSensor1Pin = A1;
-static constexpr uint8_t clusterSensor2Pin = A2;
-static constexpr uint8_t clusterSensor3Pin = A3;
-static constexpr uint8_t clusterSensor4Pin = A4;
-static uint8_t clusterSensorStates = 0;
-static uint32_t clusterSensor1DetectionMs = 0;
-static uint32_t clusterSensor2DetectionMs = 0;
-static uint32_t clusterSensor3DetectionMs = 0;
-static uint32_t clusterSensor4DetectionMs = 0;
+// The cluster sensors are described by this table alone: the pin change masks, the ISRs' port filters and
+// the bit-to-sensor lookup below are all derived from it at compile time. A sensor may sit on any pin that
+// is not otherwise used (PCINT ports B, C and D).
+typedef struct ClusterSensor {
+  uint8_t pin;
+  RGB colour;
+} ClusterSensor;
+
+static constexpr ClusterSensor clusterSensors[] = {
+  {A1, RGB(255, 153, 51)},
+  {A2, RGB(128, 255, 0)},
+  {A3, RGB(51, 51, 255)},
+  {A4, RGB(204, 0, 204)},
+};
+static constexpr uint8_t clusterSensorCount = sizeof(clusterSensors) / sizeof(clusterSensors[0]);
+static constexpr uint8_t clusterPortCount = 3;
+
+// PCINT port (0 = PB / D8-D13, 1 = PC / A0-A5, 2 = PD / D0-D7) and bit of a pin
+constexpr uint8_t PcintPort(const uint8_t pin) {
+  return pin >= A0 ? 1 : (pin >= 8 ? 0 : 2);
+}
+
+constexpr uint8_t PcintBit(const uint8_t pin) {
+  return pin >= A0 ? pin - A0 : (pin >= 8 ? pin - 8 : pin);
+}
+
+constexpr uint8_t ClusterPortMask(const uint8_t port, const uint8_t i = 0) {
+  return i == clusterSensorCount
+           ? 0
+           : ((PcintPort(clusterSensors[i].pin) == port ? (1 << PcintBit(clusterSensors[i].pin)) : 0) |
+              ClusterPortMask(port, i + 1));
+}
+
+constexpr uint8_t ClusterSensorIndex(const uint8_t port, const uint8_t bit, const uint8_t i = 0) {
+  return i == clusterSensorCount
+           ? 0xFF
+           : ((PcintPort(clusterSensors[i].pin) == port && PcintBit(clusterSensors[i].pin) == bit)
+                ? i
+                : ClusterSensorIndex(port, bit, i + 1));
+}
+
+#define CLUSTER_PORT_INDEX(port)                                                                   \
+  {                                                                                                \
+    ClusterSensorIndex(port, 0), ClusterSensorIndex(port, 1), ClusterSensorIndex(port, 2),       \
+      ClusterSensorIndex(port, 3), ClusterSensorIndex(port, 4), ClusterSensorIndex(port, 5),     \
+      ClusterSensorIndex(port, 6), ClusterSensorIndex(port, 7)                                   \
+  }
+
+static constexpr uint8_t clusterPortMasks[clusterPortCount] = {ClusterPortMask(0), ClusterPortMask(1), ClusterPortMask(2)};
+static constexpr uint8_t clusterSensorIndex[clusterPortCount][8] = {
+  CLUSTER_PORT_INDEX(0), CLUSTER_PORT_INDEX(1), CLUSTER_PORT_INDEX(2)};
+static uint8_t clusterSensorStates[clusterPortCount] = {0};
+// Per port, the latest states and the sensors seen high since the cluster task last ran
+static uint8_t clusterLatestStates[clusterPortCount] = {0};
+static uint8_t clusterRisenStates[clusterPortCount] = {0};
+static uint32_t clusterSensorDetectionMs[clusterSensorCount] = {0};
 
 static constexpr uint8_t rgbLedRedPin = 4;
 static constexpr uint8_t rgbLedBluePin = 5;
 static constexpr uint8_t rgbLedGreenPin = 6;
-static const RGB clusterSensor1Colour(255, 153, 51);
-static const RGB clusterSensor2Colour(128, 255, 0);
-static const RGB clusterSensor3Colour(51, 51, 255);
-static const RGB clusterSensor4Colour(204, 0, 204);
 
 static constexpr uint8_t tiltPin = 2;
-static volatile uint8_t tiltDetected = 0;
+// Debounced in its ISRs (see Debounce.h) on Timer1's channel B, so a rattling tilt switch posts one event per
+// settled change instead of one per bounce
+static DebouncedInput<0, 20> tiltSwitch;
 static constexpr uint8_t piezoPin = 7;
 
-static volatile uint8_t doPing = 0;
-static constexpr uint8_t signalPin = 12;
+// The ultrasonic sensors take turns so that only one ping is ever in the air: the next sensor pings a guard
+// interval after the last echo fell, once that ping has rung down, and echoes cannot cross-talk. Each turn
+// lasts as long as the range it measures, so sensors facing something close are pinged again sooner than
+// the fixed 50 ms one sensor had. The sensors share that time, so the N x 20 Hz they add up to holds only
+// while their targets are near: a far object or a missing echo holds the turn for up to the echo timeout,
+// and the pings that time out are no readings at all.
+// Timer1 free-runs at 16 us per tick and its channel A times the turns: the guard before the next ping, or
+// the timeout of an echo that never falls. The echoes are timed from the pin change events of their edges
+// on port B instead of a blocking pulseIn.
+static constexpr uint8_t ultrasonicPins[] = {12, 11, 10};
+static constexpr uint8_t ultrasonicSensorCount = sizeof(ultrasonicPins) / sizeof(ultrasonicPins[0]);
+
+constexpr uint8_t UltrasonicPortMask(const uint8_t i = 0) {
+  return i == ultrasonicSensorCount ? 0 : ((1 << PcintBit(ultrasonicPins[i])) | UltrasonicPortMask(i + 1));
+}
+
+constexpr bool UltrasonicPinsOnPortB(const uint8_t i = 0) {
+  return i == ultrasonicSensorCount || (PcintPort(ultrasonicPins[i]) == 0 && UltrasonicPinsOnPortB(i + 1));
+}
+
+static_assert(UltrasonicPinsOnPortB(), "the echoes are timed by PCINT0, so every ultrasonic sensor must be on D8-D13");
+
 static constexpr uint8_t pingLedPin = 9;
 static constexpr uint8_t minProximityCm = 3;
 static constexpr uint16_t maxProximityCm = 300;
 
+// Timer1 ticks. The guard outlasts a ping's ring-down; after an echo from beyond maxProximityCm (or none at
+// all) the far guard also lets the sound from objects out of range die away. The timeout covers the
+// sensor's hold-off and its longest echo, 18.5 ms.
+static constexpr uint16_t pingGuardTicks = 4000 / 16;
+static constexpr uint16_t pingFarGuardTicks = 10000 / 16;
+static constexpr uint16_t echoTimeoutTicks = 25000 / 16;
+static constexpr uint16_t maxProximityTicks = maxProximityCm * 58 / 16;
+
+static uint8_t pingSensor = ultrasonicSensorCount - 1; // the sensor pinged last, so the first ping is sensor 0's
+static volatile uint8_t echoArmed = 0; // port B bit of the sensor whose echo is awaited
+static uint8_t echoLevel = 0;
+static uint16_t echoRiseTicks = 0;
+static uint32_t echoRiseUs = 0;
+static uint32_t echoDurationUs = 0;
+static uint8_t echoSensor = 0;
+static uint16_t ultrasonicReadings = 0;
+static uint32_t ultrasonicRateStartMs = 0;
+
+// The next compare match of Timer1 channel A, ticks from now. The 16-bit timer registers share a temporary
+// byte, so outside the ISRs this runs with interrupts disabled.
+static void ArmPingTimer(const uint16_t ticks) {
+  OCR1A = TCNT1 + ticks;
+  TIFR1 = (1 << OCF1A);
+}
+
+static void PostEvent(const uint8_t source, const uint8_t pins) {
+  sensorEvents.Push({source, pins, micros()});
+}
+
+// loop() runs its work as tasks of an earliest-deadline-first scheduler (see TaskScheduler.h) ticking on
+// Timer0's compare channel B, every 1.024 ms beside millis() (see InitializeTimers for why the blue LED's
+// PWM on the same channel leaves that rate alone). The ISR events release the event tasks; the tilt alarm
+// and the next ping have the tightest deadlines and go ahead of the cluster LED, the PIR timeout and the
+// logging. Deadline misses and each task's worst-case execution time go out as telemetry.
+enum SketchTask : uint8_t {
+  tiltTask,
+  pingTask,
+  rangeTask,
+  clusterTask,
+  motionTask,
+  telemetryTask,
+  reportTask,
+  sketchTaskCount
+};
+
+static const TaskSpec sketchTasks[sketchTaskCount] = {
+  {HandleTiltDetected, 0, 2},
+  {HandlePing, 0, 2},
+  {HandleRange, 0, 4},
+  {HandleClusterTask, 0, 10},
+  {HandleMotionDetected, 20, 20},
+  {HandleTelemetry, 4, 20},
+  {HandleSchedulerReport, 1000, 100},
+};
+
+static TaskScheduler<sketchTaskCount> scheduler(sketchTasks);
+static uint16_t reportedMisses[sketchTaskCount] = {0};
+static uint32_t reportedWorstUs[sketchTaskCount] = {0};
+
 void changeMotionDetectedState(void) {
-  motionDetected = digitalRead(pirSensorPin);
+  PostEvent(motionEvent, digitalRead(pirSensorPin));
 }
 
 void changeTiltState(void) {
-  tiltDetected = 1;
+  tiltSwitch.PinChanged();
+}
+
+ISR(TIMER0_COMPB_vect)
+{
+  scheduler.Tick();
 }
 
+ISR(TIMER1_COMPB_vect)
+{
+  if (tiltSwitch.Sample() == debounceChanged) {
+    PostEvent(tiltEvent, tiltSwitch.fLevel);
+  }
+}
 
 ISR(TIMER1_COMPA_vect)
 {
-  doPing = 1;
+  if (echoArmed) {
+    // The echo never fell: abandon the reading and leave the far guard before the next ping
+    echoArmed = 0;
+    ArmPingTimer(pingFarGuardTicks);
+    return;
+  }
+  PostEvent(pingEvent, 0);
 }
 
 ISR(PCINT1_vect) {
-  // Interrupt triggers from any input on A1-A4
-  clusterSensorStates = (PINC & 0b00011110);
+  // Interrupt triggers from any cluster sensor on A0-A5
+  PostEvent(clusterEvent + 1, PINC & clusterPortMasks[1]);
+}
+
+ISR(PCINT2_vect) {
+  // Interrupt triggers from any cluster sensor on D0-D7
+  PostEvent(clusterEvent + 2, PIND & clusterPortMasks[2]);
+}
+
+ISR(PCINT0_vect) {
+  if (clusterPortMasks[0]) {
+    PostEvent(clusterEvent, PINB & clusterPortMasks[0]);
+  }
+  // Also triggers on both edges of the awaited echo. The trigger pulse's own edges arrive before the ping
+  // is armed, and changes of the port's other pins leave the echo's level as it was; both are ignored.
+  if (!echoArmed) {
+    return;
+  }
+  const uint8_t level = (PINB & echoArmed) ? 1 : 0;
+  if (level == echoLevel) {
+    return;
+  }
+  echoLevel = level;
+  if (level) {
+    echoRiseTicks = TCNT1;
+  } else {
+    echoArmed = 0;
+    const uint16_t echoTicks = TCNT1 - echoRiseTicks;
+    ArmPingTimer(echoTicks > maxProximityTicks ? pingFarGuardTicks : pingGuardTicks);
+  }
+  PostEvent(echoEvent, level);
 }
 
 void InitializeTimers()
 {
-  // TCCRx: Timer/Counter Control Register. Configures prescalar
+  // TCCRx: Timer/Counter Control Register. Normal mode, prescaler 256: free-running at 16 us per tick
   TCCR1A = 0;
-  TCCR1B = 0;
-  
+  TCCR1B = (1 << CS12);
+
   // Timer/Counter Register, holds timer value
   TCNT1 = 0;
-  
-  // Output compare register - 20Hz / 50ms rate
-  OCR1A = 3124;
-  
-  TCCR1B |= (1 << CS12);
+
+  // Output compare register A: the first ping, a guard interval in
+  ArmPingTimer(pingGuardTicks);
   TIMSK1 |= (1 << OCIE1A);
-  TCCR1B |= (1 << WGM12);
+
+  // The scheduler's tick: Timer0 is the core's millis() timer, and its compare channel B is shared with the
+  // blue LED's PWM on D5 (OC0B), whose analogWrite() rewrites OCR0B. Timer2 is tone()'s and Timer1 times the
+  // pings, so there is no channel nothing else uses. The tick rate survives the sharing: the core runs Timer0
+  // in fast PWM, where OCR0B is double-buffered and takes a new value only at BOTTOM, so the count passes it
+  // exactly once per 1.024 ms overflow period whatever it holds. A new LED colour only moves the tick's phase
+  // within the period, stretching or shortening that one tick by less than a period, which the deadlines,
+  // counted in ticks, absorb. The host simulator keeps OCR0B where it is set here and does not model this.
+  OCR0B = 0x80;
+  TIMSK0 |= (1 << OCIE0B);
 }
 
 void InitInterrupts() {
-  // Enable interrupts on PC port (Analog 0-5)
-  PCICR |= 0b00000010;
-  // Mask interrupts for A1 - A4
-  PCMSK1 |= 0b00011110;
+  // Mask interrupts for every cluster sensor, plus the ultrasonic echoes (PB port)
+  PCMSK0 |= clusterPortMasks[0] | UltrasonicPortMask();
+  PCMSK1 |= clusterPortMasks[1];
+  PCMSK2 |= clusterPortMasks[2];
+  // Enable interrupts on the PB port and on the PC (Analog 0-5) and PD ports when they have a sensor
+  PCICR |= (1 << PCIE0) | (clusterPortMasks[1] ? (1 << PCIE1) : 0) | (clusterPortMasks[2] ? (1 << PCIE2) : 0);
 }
 
-void ResetPingState()
+void ResetPingState(const uint8_t pin)
 {
-  pinMode(signalPin, OUTPUT);
-  digitalWrite(signalPin, LOW);
+  pinMode(pin, OUTPUT);
+  digitalWrite(pin, LOW);
   delayMicroseconds(2);
-  digitalWrite(signalPin, HIGH);
+  digitalWrite(pin, HIGH);
   delayMicroseconds(5);
-  digitalWrite(signalPin, LOW);
-  pinMode(signalPin, INPUT);
+  digitalWrite(pin, LOW);
+  pinMode(pin, INPUT);
+  noInterrupts();
+  echoLevel = 0;
+  echoArmed = (1 << PcintBit(pin));
+  ArmPingTimer(echoTimeoutTicks);
+  interrupts();
 }
 
 void setup()
@@ -103,29 +311,85 @@ void setup()
   noInterrupts();
   InitializeTimers();
   InitInterrupts();
-  attachInterrupt(digitalPinToInterrupt(tiltPin), changeTiltState, CHANGE);
   attachInterrupt(digitalPinToInterrupt(pirSensorPin), changeMotionDetectedState, CHANGE);
   pinMode(tiltPin, INPUT);
+  tiltSwitch.Begin();
+  attachInterrupt(digitalPinToInterrupt(tiltPin), changeTiltState, CHANGE);
   pinMode(piezoPin, OUTPUT);
-  pinMode(clusterSensor1Pin, INPUT);
-  pinMode(clusterSensor2Pin, INPUT);
-  pinMode(clusterSensor3Pin, INPUT);
-  pinMode(clusterSensor4Pin, INPUT);
+  for (uint8_t i = 0; i < clusterSensorCount; ++i) {
+    pinMode(clusterSensors[i].pin, INPUT);
+  }
   pinMode(rgbLedRedPin, OUTPUT);
   pinMode(rgbLedBluePin, OUTPUT);
   pinMode(rgbLedGreenPin, OUTPUT);
   pinMode(LED_BUILTIN, OUTPUT);
   pinMode(pingLedPin, OUTPUT);
-  Serial.begin(9600);
+  Serial.begin(telemetryBaud);
+  telemetry.Post(telemetryStart, 0, telemetryVersion, micros());
   interrupts();
 }
 
 void loop()
 {
-  HandleMotionDetected();
-  HandleTiltDetected();
-  HandlePing();
-  HandleClusterSensors();
+  // The queued events release their tasks again before every task, so an alarm that arrives while other
+  // work is waiting still runs first
+  do {
+    ReleaseEventTasks();
+  } while (scheduler.RunNext(micros));
+  SleepUnless([]() { return sensorEvents.Size() || scheduler.Pending(); });
+}
+
+// Only the events queued when it starts, so a stream of events that arrive faster than they are handled
+// cannot keep it from ever returning
+void ReleaseEventTasks() {
+  SensorEvent event;
+  for (uint8_t pending = sensorEvents.Size(); pending && sensorEvents.Pop(event); --pending) {
+    HandleEvent(event);
+  }
+}
+
+void HandleEvent(const SensorEvent& event) {
+  switch (event.source) {
+    case motionEvent:
+      motionDetected = event.pins;
+      break;
+    case tiltEvent:
+      scheduler.Post(tiltTask);
+      break;
+    case pingEvent:
+      scheduler.Post(pingTask);
+      break;
+    case echoEvent:
+      HandleEcho(event);
+      break;
+    default:
+      if (event.source >= clusterEvent) {
+        const uint8_t port = event.source - clusterEvent;
+        clusterLatestStates[port] = event.pins;
+        clusterRisenStates[port] |= event.pins;
+        scheduler.Post(clusterTask);
+      }
+      break;
+  }
+}
+
+void HandleTelemetry() {
+  telemetry.Pump(Serial);
+}
+
+// Sends the deadlines missed since the last report, and each task's worst-case execution time when it grows
+void HandleSchedulerReport() {
+  for (uint8_t task = 0; task < sketchTaskCount; ++task) {
+    const TaskStats& stats = scheduler.fStats[task];
+    if (stats.fMisses != reportedMisses[task]) {
+      telemetry.Post(telemetryDeadlineMiss, task, stats.fMisses - reportedMisses[task], micros());
+      reportedMisses[task] = stats.fMisses;
+    }
+    if (stats.fWorstUs > reportedWorstUs[task]) {
+      telemetry.Post(telemetryTaskWcet, task, stats.fWorstUs > 32767 ? 32767 : stats.fWorstUs, micros());
+      reportedWorstUs[task] = stats.fWorstUs;
+    }
+  }
 }
 
 void HandleMotionDetected() {
@@ -133,10 +397,7 @@ void HandleMotionDetected() {
     if ((millis() - lastMotionDetectionMs) > motionTimeoutMs) {
       digitalWrite(LED_BUILTIN, HIGH);
       lastMotionDetectionMs = millis();
-      Serial.println("Motion detected!");
-      Serial.print("Last detection time = ");
-      Serial.print(lastMotionDetectionMs);
-      Serial.println("ms");
+      telemetry.Post(telemetryMotion, 0, 1, micros());
     }
   } else {
     digitalWrite(LED_BUILTIN, LOW);
@@ -144,39 +405,54 @@ void HandleMotionDetected() {
 }
 
 void HandleTiltDetected() {
-  if (tiltDetected) {
-    Serial.println("Tilt Detected!");
-    tone(piezoPin, 494, 5);
-    tiltDetected = 0;
-  }
+  telemetry.Post(telemetryTilt, 0, 0, micros());
+  tone(piezoPin, 494, 5);
 }
 
 void HandlePing() {
-  if (doPing) {
-    ResetPingState();
-    HandleRead();
-    doPing = 0;
+  pingSensor = (pingSensor + 1) % ultrasonicSensorCount;
+  ResetPingState(ultrasonicPins[pingSensor]);
+}
+
+void HandleEcho(const SensorEvent& event) {
+  if (event.pins) {
+    echoRiseUs = event.timeUs;
+    return;
   }
+  echoDurationUs = event.timeUs - echoRiseUs;
+  echoSensor = pingSensor;
+  scheduler.Post(rangeTask);
 }
 
-void HandleRead()
+void HandleRange() {
+  HandleRead(echoSensor, echoDurationUs);
+
+  // Readings per second, all sensors together
+  ultrasonicReadings++;
+  const uint32_t nowMs = millis();
+  if (nowMs - ultrasonicRateStartMs >= 1000) {
+    telemetry.Post(telemetryPingRate, 0, ultrasonicReadings * 1000UL / (nowMs - ultrasonicRateStartMs), micros());
+    ultrasonicReadings = 0;
+    ultrasonicRateStartMs = nowMs;
+  }
+}
+
+void HandleRead(const uint8_t sensor, const uint32_t durationUs)
 {
   // Speed of sound = 343 m/s == 34,300 cm/s
   // 34,300 / 1*10^-6 = 0.0343 cm/us
   // 1 / 0.0343 = 29.1 us/cm
-  unsigned long durationUs = pulseIn(signalPin, HIGH);
   unsigned short distanceCm = (durationUs / 2) / 29;
 
-  HandleProximity(distanceCm);
+  HandleProximity(sensor, distanceCm);
 }
 
-void HandleProximity(const unsigned short distanceCm)
+void HandleProximity(const uint8_t sensor, const unsigned short distanceCm)
 {
   if (distanceCm <= maxProximityCm && distanceCm >= minProximityCm)
   {
     digitalWrite(pingLedPin, HIGH);
-    Serial.print(distanceCm);
-    Serial.println(" cm");
+    telemetry.Post(telemetryDistance, sensor, distanceCm, micros());
   }
   else
   {
@@ -184,45 +460,46 @@ void HandleProximity(const unsigned short distanceCm)
   }
 }
 
-void HandleClusterSensors(void)
-{
-  if (clusterSensorStates & 0b00000010) {
-    if ((millis() - clusterSensor1DetectionMs) > motionTimeoutMs) {
-      analogWrite(rgbLedRedPin, clusterSensor1Colour.red);
-      analogWrite(rgbLedGreenPin, clusterSensor1Colour.green);
-      analogWrite(rgbLedBluePin, clusterSensor1Colour.blue);
-      Serial.println("Motion detected on sensor 1");
-      clusterSensor1DetectionMs = millis();
+// Handles every port with new states. A sensor that went high and low again since is handled as high first,
+// so its detection is not lost, and then settled at its latest state.
+void HandleClusterTask() {
+  for (uint8_t port = 0; port < clusterPortCount; ++port) {
+    const uint8_t risen = clusterRisenStates[port];
+    if (!risen && clusterLatestStates[port] == clusterSensorStates[port]) {
+      continue;
     }
-  }
-  if (clusterSensorStates & 0b00000100) {
-    if ((millis() - clusterSensor2DetectionMs) > motionTimeoutMs) {
-      analogWrite(rgbLedRedPin, clusterSensor2Colour.red);
-      analogWrite(rgbLedGreenPin, clusterSensor2Colour.green);
-      analogWrite(rgbLedBluePin, clusterSensor2Colour.blue);
-      Serial.println("Motion detected on sensor 2");
-      clusterSensor2DetectionMs = millis();
+    clusterRisenStates[port] = 0;
+    HandleClusterSensors(port, clusterLatestStates[port] | risen);
+    if (risen & ~clusterLatestStates[port]) {
+      HandleClusterSensors(port, clusterLatestStates[port]);
     }
   }
-  if (clusterSensorStates & 0b00001000) {
-    if ((millis() - clusterSensor3DetectionMs) > motionTimeoutMs) {
-      analogWrite(rgbLedRedPin, clusterSensor3Colour.red);
-      analogWrite(rgbLedGreenPin, clusterSensor3Colour.green);
-      analogWrite(rgbLedBluePin, clusterSensor3Colour.blue);
-      Serial.println("Motion detected on sensor 3");
-      clusterSensor3DetectionMs = millis();
+}
+
+// Visits only the set bits of the port's states. The LED shows the colour of the last sensor detected, so
+// it is written once per event rather than once per sensor.
+void HandleClusterSensors(const uint8_t port, const uint8_t states)
+{
+  clusterSensorStates[port] = states;
+  const uint32_t nowMs = millis();
+  const ClusterSensor* detected = nullptr;
+  uint8_t bit = 0;
+  for (uint8_t pending = states; pending; pending >>= 1, ++bit) {
+    if (!(pending & 1)) {
+      continue;
     }
-  }
-  if (clusterSensorStates & 0b00010000) {
-    if ((millis() - clusterSensor4DetectionMs) > motionTimeoutMs) {
-      analogWrite(rgbLedRedPin, clusterSensor4Colour.red);
-      analogWrite(rgbLedGreenPin, clusterSensor4Colour.green);
-      analogWrite(rgbLedBluePin, clusterSensor4Colour.blue);
-      Serial.println("Motion detected on sensor 4");
-      clusterSensor4DetectionMs = millis();
+    const uint8_t index = clusterSensorIndex[port][bit];
+    if ((nowMs - clusterSensorDetectionMs[index]) > motionTimeoutMs) {
+      clusterSensorDetectionMs[index] = nowMs;
+      detected = &clusterSensors[index];
+      telemetry.Post(telemetryClusterMotion, index, 1, micros());
     }
   }
-  if (!clusterSensorStates) {
+  if (detected) {
+    analogWrite(rgbLedRedPin, detected->colour.red);
+    analogWrite(rgbLedGreenPin, detected->colour.green);
+    analogWrite(rgbLedBluePin, detected->colour.blue);
+  } else if (!(clusterSensorStates[0] | clusterSensorStates[1] | clusterSensorStates[2])) {
     analogWrite(rgbLedRedPin, 0);
     analogWrite(rgbLedGreenPin, 0);
     analogWrite(rgbLedBluePin, 0);
@@ -0,0 +1,125 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <stdint.h>
+
+// A cooperative earliest-deadline-first scheduler for loop(). Work is split into tasks, each with a
+// deadline: a periodic task is released every fPeriodTicks, an event task when loop() posts it (e.g. on an
+// ISR's event). RunNext runs the released task whose deadline comes first, so an alarm with a short deadline
+// overtakes logging work released earlier. Tasks run to completion, so an urgent release can still wait for
+// the task already running: keep every task short.
+//
+// Time is counted in ticks of one timer interrupt, whose ISR only calls Tick. Tick bumps an 8-bit count
+// and loop() folds it into the 16-bit clock the deadlines are kept in, so no tick is missed and nothing
+// needs interrupts disabled as long as loop() looks at least every 255 ticks. Deadlines and periods must
+// stay below 32768 ticks.
+//
+// Every run is timed with the clock passed to RunNext (micros()) and each task keeps its worst-case execution
+// time, its runs, and its deadline misses: releases completed more than fDeadlineTicks after they were
+// released. A release while the task is still waiting to run is folded into the waiting one, whose deadline
+// stands. Post and RunNext must both be called from loop().
+
+typedef struct TaskSpec {
+  void (*fRun)(void);
+  uint16_t fPeriodTicks;   // 0 for an event task
+  uint16_t fDeadlineTicks; // from release to completion
+} TaskSpec;
+
+typedef struct TaskStats {
+  uint32_t fRuns;
+  uint32_t fWorstUs;    // worst-case execution time
+  uint16_t fWorstTicks; // worst release-to-completion time
+  uint16_t fMisses;
+} TaskStats;
+
+template <uint8_t Count>
+struct TaskScheduler {
+  static_assert(Count > 0 && Count <= 32, "the released tasks are one bit each of fReady");
+
+  explicit TaskScheduler(const TaskSpec (&inTasks)[Count]) : fTasks(inTasks) {}
+
+  // From the tick ISR
+  void Tick() { fTickCount++; }
+
+  // Releases an event task now
+  void Post(const uint8_t inTask) {
+    Update();
+    Release(inTask, fNow);
+  }
+
+  // A tick loop() has not seen yet, or a released task waiting to run
+  bool Pending() const { return fTickCount != fSeenTicks || fReady; }
+
+  // Runs the released task with the earliest deadline; false when none is released
+  template <typename Clock>
+  bool RunNext(const Clock& inMicros) {
+    Update();
+    uint8_t aNext = Count;
+    int16_t aSoonest = 0;
+    for (uint8_t i = 0; i < Count; ++i) {
+      if (!(fReady & (1UL << i)))
+        continue;
+      const int16_t aLeft = static_cast<int16_t>(fReleasedAt[i] + fTasks[i].fDeadlineTicks - fNow);
+      if (aNext == Count || aLeft < aSoonest) {
+        aNext = i;
+        aSoonest = aLeft;
+      }
+    }
+    if (aNext == Count)
+      return false;
+
+    fReady &= ~(1UL << aNext);
+    const uint32_t aStart = inMicros();
+    fTasks[aNext].fRun();
+    const uint32_t aRunUs = inMicros() - aStart;
+    Update();
+
+    TaskStats& aStats = fStats[aNext];
+    aStats.fRuns++;
+    if (aRunUs > aStats.fWorstUs) {
+      aStats.fWorstUs = aRunUs;
+    }
+    const uint16_t aTicks = fNow - fReleasedAt[aNext];
+    if (aTicks > aStats.fWorstTicks) {
+      aStats.fWorstTicks = aTicks;
+    }
+    if (aTicks > fTasks[aNext].fDeadlineTicks) {
+      aStats.fMisses++;
+    }
+    return true;
+  }
+
+  // Catches the clock up with the ticks counted since and releases the periodic tasks that have come due
+  void Update() {
+    const uint8_t aTicks = fTickCount;
+    fNow += static_cast<uint8_t>(aTicks - fSeenTicks);
+    fSeenTicks = aTicks;
+    for (uint8_t i = 0; i < Count; ++i) {
+      const uint16_t aPeriod = fTasks[i].fPeriodTicks;
+      if (!aPeriod)
+        continue;
+      while (static_cast<int16_t>(fNow - fNextRelease[i]) >= 0) {
+        Release(i, fNextRelease[i]);
+        fNextRelease[i] += aPeriod;
+      }
+    }
+  }
+
+  void Release(const uint8_t inTask, const uint16_t inAt) {
+    if (fReady & (1UL << inTask))
+      return;
+    fReady |= (1UL << inTask);
+    fReleasedAt[inTask] = inAt;
+  }
+
+  const TaskSpec (&fTasks)[Count];
+  volatile uint8_t fTickCount = 0;
+  uint8_t fSeenTicks = 0;
+  uint16_t fNow = 0;
+  uint32_t fReady = 0; // one bit per released task
+  uint16_t fReleasedAt[Count] = {};
+  uint16_t fNextRelease[Count] = {}; // periodic tasks are first released at tick 0
+  TaskStats fStats[Count] = {};
+};
+
+#endif // TASK_SCHEDULER_H
@@ -0,0 +1,121 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+#include "EventRing.h"
+
+// Binary telemetry that replaces the sketches' Serial.print text. Every record is one 10-byte frame:
+//
+//   0xA5 | event | sensor | timestamp (us, 4 bytes LE) | value (signed, 2 bytes LE) | CRC-8
+//
+// The CRC (polynomial 0x07 over event..value) lets the decoder (HostSim/Telemetry-Decoder.cpp) resynchronise
+// on the sync byte after lost or corrupted bytes. At 115200 baud a frame is 0.87 ms on the wire; a line
+// like "Motion detected on sensor 1" took 30 ms at 9600 baud.
+//
+// Frames are posted to a TelemetryLink, an EventRing of frames, and loop() pumps them into the UART only
+// while its TX buffer has room for a whole frame, so logging never blocks. A frame posted to a full ring is
+// dropped and the number lost is sent in a telemetryDropped frame once there is room again. As with the
+// EventRing, all posts must come from one side: loop() or the ISRs, not both.
+
+enum TelemetryEvent : uint8_t {
+  telemetryStart,         // value = frame format version
+  telemetryDropped,       // value = frames dropped since the last report
+  telemetryMotion,        // PIR motion after the timeout, value = 1
+  telemetryTilt,          // tilt switch changed
+  telemetryDistance,      // sensor = ultrasonic sensor index, value = distance in cm
+  telemetryClusterMotion, // sensor = cluster sensor index
+  telemetryButton,        // value = new LED state
+  telemetryBounce,        // the button bounced but settled back where it was
+  telemetryPingRate,      // value = ultrasonic readings per second, all sensors
+  telemetryDeadlineMiss,  // sensor = scheduler task, value = deadlines missed since the last report
+  telemetryTaskWcet,      // sensor = scheduler task, value = its new worst-case execution time in us
+  telemetryEventCount
+};
+
+static constexpr uint8_t telemetrySync = 0xA5;
+static constexpr uint8_t telemetryVersion = 1;
+static constexpr uint8_t telemetryFrameBytes = 10;
+static constexpr unsigned long telemetryBaud = 115200;
+
+typedef struct TelemetryFrame {
+  uint8_t fEvent;
+  uint8_t fSensor;
+  int16_t fValue;
+  uint32_t fTimeUs;
+} TelemetryFrame;
+
+inline uint8_t TelemetryCrc8(const uint8_t* inData, const uint8_t inLength) {
+  uint8_t aCrc = 0;
+  for (uint8_t i = 0; i < inLength; ++i) {
+    aCrc ^= inData[i];
+    for (uint8_t aBit = 0; aBit < 8; ++aBit) {
+      aCrc = static_cast<uint8_t>((aCrc & 0x80) ? (aCrc << 1) ^ 0x07 : aCrc << 1);
+    }
+  }
+  return aCrc;
+}
+
+inline void EncodeTelemetryFrame(const TelemetryFrame& inFrame, uint8_t* outBytes) {
+  outBytes[0] = telemetrySync;
+  outBytes[1] = inFrame.fEvent;
+  outBytes[2] = inFrame.fSensor;
+  for (uint8_t i = 0; i < 4; ++i) {
+    outBytes[3 + i] = static_cast<uint8_t>(inFrame.fTimeUs >> (8 * i));
+  }
+  outBytes[7] = static_cast<uint8_t>(inFrame.fValue);
+  outBytes[8] = static_cast<uint8_t>(static_cast<uint16_t>(inFrame.fValue) >> 8);
+  outBytes[9] = TelemetryCrc8(outBytes + 1, telemetryFrameBytes - 2);
+}
+
+// Returns false unless inBytes starts with the sync byte and carries a valid CRC
+inline bool DecodeTelemetryFrame(const uint8_t* inBytes, TelemetryFrame& outFrame) {
+  if (inBytes[0] != telemetrySync || TelemetryCrc8(inBytes + 1, telemetryFrameBytes - 2) != inBytes[9])
+    return false;
+  outFrame.fEvent = inBytes[1];
+  outFrame.fSensor = inBytes[2];
+  outFrame.fTimeUs = 0;
+  for (uint8_t i = 0; i < 4; ++i) {
+    outFrame.fTimeUs |= static_cast<uint32_t>(inBytes[3 + i]) << (8 * i);
+  }
+  outFrame.fValue = static_cast<int16_t>(inBytes[7] | (inBytes[8] << 8));
+  return true;
+}
+
+template <uint8_t Capacity>
+struct TelemetryLink {
+  // Returns false, counting the frame as dropped, when the ring is full
+  bool Post(const uint8_t inEvent, const uint8_t inSensor, const int16_t inValue, const uint32_t inTimeUs) {
+    if (fFrames.Push({inEvent, inSensor, inValue, inTimeUs}))
+      return true;
+    fDroppedAtUs = inTimeUs;
+    return false;
+  }
+
+  // Moves whole frames into the port's TX buffer while it has room for them; never waits for the UART.
+  // Port is the Arduino HardwareSerial (availableForWrite, write(buffer, size)).
+  template <typename Port>
+  void Pump(Port& inPort) {
+    const uint8_t aDropped = fFrames.Dropped();
+    if (!fFrames.Size() && aDropped == fReportedDropped)
+      return;
+    uint8_t aBytes[telemetryFrameBytes];
+    if (aDropped != fReportedDropped && inPort.availableForWrite() >= telemetryFrameBytes) {
+      const int16_t aLost = static_cast<uint8_t>(aDropped - fReportedDropped);
+      EncodeTelemetryFrame({telemetryDropped, 0, aLost, fDroppedAtUs}, aBytes);
+      inPort.write(aBytes, telemetryFrameBytes);
+      fReportedDropped = aDropped;
+    }
+    TelemetryFrame aFrame;
+    while (inPort.availableForWrite() >= telemetryFrameBytes && fFrames.Pop(aFrame)) {
+      EncodeTelemetryFrame(aFrame, aBytes);
+      inPort.write(aBytes, telemetryFrameBytes);
+    }
+  }
+
+  EventRing<TelemetryFrame, Capacity> fFrames;
+  uint8_t fReportedDropped = 0;
+  uint32_t fDroppedAtUs = 0; // time of the latest drop, the timestamp of the telemetryDropped frame
+};
+
+#endif // TELEMETRY_H
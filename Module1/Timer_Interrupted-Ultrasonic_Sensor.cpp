@@ -1,12 +1,24 @@
 // https://www.arduino.cc/reference/en/language/functions/external-interrupts/attachinterrupt/
 // https://www.instructables.com/Arduino-Timer-Interrupts/
 
+#include "IdleSleep.h"
+#include "Telemetry.h"
+
 constexpr unsigned char SIGNAL_PIN = 2;
 constexpr unsigned short MAX_PROXIMITY_CM = 400;
 constexpr unsigned short MIN_PROXIMITY_CM = 3;
 
 static volatile char DoPing = 0;
 
+// The echo is timed from INT0 edge timestamps instead of a blocking pulseIn
+static volatile char EchoArmed = 0;
+static volatile char EchoReady = 0;
+static volatile unsigned long EchoRiseUs = 0;
+static volatile unsigned long EchoDurationUs = 0;
+
+// Distances go out as binary frames (see Telemetry.h), posted by loop() only
+static TelemetryLink<8> Telemetry;
+
 void InitializeTimers()
 {
   // TCCRx: Timer/Counter Control Register. Configures prescalar
@@ -33,6 +45,8 @@ void ResetPingState()
   delayMicroseconds(5);
   digitalWrite(SIGNAL_PIN, LOW);
   pinMode(SIGNAL_PIN, INPUT);
+  // Re-arming abandons a previous ping whose echo never fell
+  EchoArmed = 1;
 }
 
 ISR(TIMER1_COMPA_vect)
@@ -40,12 +54,26 @@ ISR(TIMER1_COMPA_vect)
   DoPing = 1;
 }
 
-void HandleRead()
+// Both edges of the echo. The trigger pulse's own edges arrive before the ping is armed and are ignored.
+void EchoEdge()
+{
+  if (!EchoArmed)
+    return;
+  const unsigned long nowUs = micros();
+  if (digitalRead(SIGNAL_PIN)) {
+    EchoRiseUs = nowUs;
+  } else {
+    EchoDurationUs = nowUs - EchoRiseUs;
+    EchoArmed = 0;
+    EchoReady = 1;
+  }
+}
+
+void HandleRead(const unsigned long durationUs)
 {
   // Speed of sound = 343 m/s == 34,300 cm/s
   // 34,300 / 1*10^-6 = 0.0343 cm/us
   // 1 / 0.0343 = 29.1 us/cm
-  unsigned long durationUs = pulseIn(SIGNAL_PIN, HIGH);
   unsigned short distanceCm = (durationUs / 2) / 29;
 
   HandleProximity(distanceCm);
@@ -56,8 +84,7 @@ void HandleProximity(const unsigned short distanceCm)
   if (distanceCm <= MAX_PROXIMITY_CM && distanceCm >= MIN_PROXIMITY_CM)
   {
     digitalWrite(LED_BUILTIN, HIGH);
-    Serial.print(distanceCm);
-    Serial.println(" cm");
+    Telemetry.Post(telemetryDistance, 0, distanceCm, micros());
   }
   else
   {
@@ -69,7 +96,9 @@ void setup()
 {
   noInterrupts();
   InitializeTimers();
-  Serial.begin(9600);
+  attachInterrupt(digitalPinToInterrupt(SIGNAL_PIN), EchoEdge, CHANGE);
+  Serial.begin(telemetryBaud);
+  Telemetry.Post(telemetryStart, 0, telemetryVersion, micros());
   pinMode(LED_BUILTIN, OUTPUT);
   interrupts();
 }
@@ -78,7 +107,15 @@ void loop()
 {
   if (DoPing) {
     ResetPingState();
-    HandleRead(); 
     DoPing = 0;
   }
+  if (EchoReady) {
+    noInterrupts();
+    const unsigned long durationUs = EchoDurationUs;
+    EchoReady = 0;
+    interrupts();
+    HandleRead(durationUs);
+  }
+  Telemetry.Pump(Serial);
+  SleepUnless([]() { return DoPing || EchoReady || Telemetry.fFrames.Size(); });
 }
\ No newline at end of file
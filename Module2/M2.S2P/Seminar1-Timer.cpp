@@ -5,7 +5,21 @@
 constexpr uint32_t clockFrequencyHz = 16000000;
 const byte LED_PIN = 13;
 const byte METER_PIN = A4;
-volatile int lastPotentiometerValue = 0;
+
+// The ADC samples METER_PIN free-running, a conversion every 104 us, and ADC_vect filters the readings:
+// an 8-sample moving average, published only once the window has settled (every sample within
+// noiseBandLsb of the average) and the average has left a hysteresis band around the last published value.
+// One-LSB jitter therefore never reaches loop(), and a real turn of the knob publishes once it comes to rest
+// rather than on every step of the average's ramp.
+constexpr uint8_t averageWindow = 8;
+constexpr uint8_t noiseBandLsb = 2;
+constexpr uint8_t hysteresisLsb = 2;
+uint16_t samples[averageWindow] = {0};
+uint16_t sampleSum = 0;
+uint8_t sampleIndex = 0;
+uint8_t settledSamples = 0;
+volatile uint16_t filteredPotentiometerValue = 0;
+volatile uint8_t potentiometerChanged = 0;
 
 typedef struct Prescaler {
   uint16_t csRegisterValue;
@@ -13,6 +27,53 @@ typedef struct Prescaler {
   Prescaler() = default;
 } Prescaler;
 
+// The potentiometer selects potentioVal / 4 Hz. Every reading's Timer1 setting is precomputed here, so
+// retuning from loop() is a flash read and a few register writes instead of a floating-point division
+// and the prescaler search. Each reading takes the smallest prescaler whose tick count still fits OCR1A,
+// which gives the same ranges as determinePrescaler. The ticks are exact integer quotients; reading 0
+// (0 Hz) is clamped to the slowest setting. HostSim/Seminar1-Timer-Table-Test.cpp checks the table
+// against determinePrescaler and the division in startTimer.
+constexpr uint32_t potentiometerStepsPerHz = 4;
+constexpr uint16_t potentiometerSteps = 1024;
+constexpr uint16_t prescalers[] = {1, 8, 64, 256, 1024};
+constexpr uint8_t prescalerCsBits[] = {(1 << CS10), (1 << CS11), (1 << CS10) | (1 << CS11), (1 << CS12),
+                                       (1 << CS10) | (1 << CS12)};
+
+typedef struct TimerSetting {
+  uint16_t ticks;
+  uint8_t csRegisterValue;
+} TimerSetting;
+
+constexpr uint32_t TimerTicks(const uint16_t potentioVal, const uint8_t prescalerIndex) {
+  return clockFrequencyHz * potentiometerStepsPerHz / (static_cast<uint32_t>(prescalers[prescalerIndex]) * potentioVal);
+}
+
+constexpr uint8_t PrescalerIndex(const uint16_t potentioVal, const uint8_t prescalerIndex = 0) {
+  return (prescalerIndex == 4 || TimerTicks(potentioVal, prescalerIndex) <= 0xFFFF)
+           ? prescalerIndex
+           : PrescalerIndex(potentioVal, prescalerIndex + 1);
+}
+
+constexpr TimerSetting TimerSettingFor(const uint16_t potentioVal) {
+  return potentioVal == 0
+           ? TimerSetting{0xFFFF, prescalerCsBits[4]}
+           : TimerSetting{static_cast<uint16_t>(TimerTicks(potentioVal, PrescalerIndex(potentioVal))),
+                          prescalerCsBits[PrescalerIndex(potentioVal)]};
+}
+
+#define TIMER_SETTINGS_4(v) TimerSettingFor(v), TimerSettingFor(v + 1), TimerSettingFor(v + 2), TimerSettingFor(v + 3)
+#define TIMER_SETTINGS_16(v) TIMER_SETTINGS_4(v), TIMER_SETTINGS_4(v + 4), TIMER_SETTINGS_4(v + 8), TIMER_SETTINGS_4(v + 12)
+#define TIMER_SETTINGS_64(v) \
+  TIMER_SETTINGS_16(v), TIMER_SETTINGS_16(v + 16), TIMER_SETTINGS_16(v + 32), TIMER_SETTINGS_16(v + 48)
+#define TIMER_SETTINGS_256(v) \
+  TIMER_SETTINGS_64(v), TIMER_SETTINGS_64(v + 64), TIMER_SETTINGS_64(v + 128), TIMER_SETTINGS_64(v + 192)
+
+// 3 KB, kept in flash
+constexpr TimerSetting timerSettings[potentiometerSteps] PROGMEM = {
+  TIMER_SETTINGS_256(0), TIMER_SETTINGS_256(256), TIMER_SETTINGS_256(512), TIMER_SETTINGS_256(768)};
+static_assert(TimerSettingFor(976).csRegisterValue == (1 << CS11) && TimerSettingFor(977).csRegisterValue == (1 << CS10),
+              "244 Hz is the fastest frequency that needs a prescaler");
+
 void setup()
 {
   pinMode(LED_PIN, OUTPUT);
@@ -21,14 +82,49 @@ void setup()
   Serial.begin(9600);
   
   startTimer(0.5);
+  startSampling();
 }
 
 void loop()
 {
-  int potentioVal = analogRead(METER_PIN);
-  if (potentioVal != lastPotentiometerValue) {
-    startTimer((double)potentioVal / 4.0);
-    lastPotentiometerValue = potentioVal;
+  if (potentiometerChanged) {
+    noInterrupts();
+    const uint16_t potentioVal = filteredPotentiometerValue;
+    potentiometerChanged = 0;
+    interrupts();
+    retuneTimer(potentioVal);
+  }
+}
+
+void startSampling() {
+  // AVcc reference, METER_PIN's channel
+  ADMUX = (1 << REFS0) | (METER_PIN - A0);
+  // Free running (ADTS2:0 = 0) with the conversion complete interrupt, ADC clock 16 MHz / 128 = 125 kHz
+  ADCSRB = 0;
+  ADCSRA = (1 << ADEN) | (1 << ADATE) | (1 << ADIE) | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+  ADCSRA |= (1 << ADSC);
+}
+
+ISR(ADC_vect) {
+  const uint16_t sample = ADC;
+  sampleSum += sample - samples[sampleIndex];
+  samples[sampleIndex] = sample;
+  sampleIndex = (sampleIndex + 1) % averageWindow;
+  const uint16_t average = sampleSum / averageWindow;
+
+  const uint16_t deviation = (sample > average ? sample - average : average - sample);
+  if (deviation > noiseBandLsb) {
+    settledSamples = 0;
+    return;
+  }
+  if (settledSamples < averageWindow) {
+    settledSamples++;
+    return;
+  }
+  const uint16_t published = filteredPotentiometerValue;
+  if (average > published + hysteresisLsb || published > average + hysteresisLsb) {
+    filteredPotentiometerValue = average;
+    potentiometerChanged = 1;
   }
 }
 
@@ -58,7 +154,7 @@ struct Prescaler determinePrescaler(const double timerFrequencyHz) {
     prescaler.csRegisterValue = (1 << CS11);
   } else {
     prescaler.prescaler = 1;
-    prescaler.csRegisterValue |= (1 << CS10);
+    prescaler.csRegisterValue = (1 << CS10);
   }
   return prescaler;
 }
@@ -66,17 +162,25 @@ struct Prescaler determinePrescaler(const double timerFrequencyHz) {
 void startTimer(const double timerFrequency){
   Serial.print("Setting frequency to ");
   Serial.println(timerFrequency);
-  noInterrupts();
   const Prescaler prescaler = determinePrescaler(timerFrequency);
   
   unsigned short ticks = (clockFrequencyHz / (prescaler.prescaler * timerFrequency));
   Serial.println("ticks = ");
   Serial.println(ticks);
+  loadTimer(prescaler.csRegisterValue, ticks);
+}
+
+void retuneTimer(const uint16_t potentioVal) {
+  loadTimer(pgm_read_byte(&timerSettings[potentioVal].csRegisterValue), pgm_read_word(&timerSettings[potentioVal].ticks));
+}
+
+void loadTimer(const uint16_t csRegisterValue, const uint16_t ticks) {
+  noInterrupts();
   TCCR1A = 0;
   TCCR1B = 0;
   TCNT1 = 0;
   OCR1A = ticks;
-  TCCR1B |= prescaler.csRegisterValue;
+  TCCR1B |= csRegisterValue;
   TIMSK1 |= (1 << OCIE1A);
   TCCR1B |= (1 << WGM12);
   
@@ -0,0 +1,92 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "batched_matrix.h"
+
+// Multiplies a batch of independent small matrices one MultiplyMatrices call at a time, each on its own pool,
+// then as one batch of Matrix pointers and as one strided batch, with the size's own kernel and with the
+// runtime-size one, and checks every result against the first.
+//
+// Usage: batched_multiplication.o [matrixSize] [batchCount]
+
+static long Microseconds(const std::chrono::high_resolution_clock::time_point inStart) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - inStart)
+    .count();
+}
+
+int main(int argc, char** argv) {
+  const uint16_t matrixSize = (argc > 1 ? atoi(argv[1]) : 8);
+  const uint32_t batchCount = (argc > 2 ? strtoul(argv[2], NULL, 10) : 20000);
+  const std::size_t stride = static_cast<std::size_t>(matrixSize) * matrixSize;
+
+  std::vector<std::unique_ptr<Matrix>> A, B, C;
+  std::vector<const Matrix*> pointersA, pointersB;
+  std::vector<Matrix*> pointersC;
+  std::vector<int> stridedA(stride * batchCount), stridedB(stride * batchCount);
+  std::vector<int> stridedC(stride * batchCount, 0), genericC(stride * batchCount, 0);
+  for (uint32_t b = 0; b < batchCount; ++b) {
+    A.emplace_back(new Matrix(matrixSize));
+    B.emplace_back(new Matrix(matrixSize));
+    C.emplace_back(new Matrix(matrixSize));
+    GenerateMatrices(*A.back(), *B.back());
+    pointersA.push_back(A.back().get());
+    pointersB.push_back(B.back().get());
+    pointersC.push_back(C.back().get());
+    for (uint16_t i = 0; i < matrixSize; ++i) {
+      for (uint16_t j = 0; j < matrixSize; ++j) {
+        stridedA[b * stride + i * matrixSize + j] = A.back()->data[i][j];
+        stridedB[b * stride + i * matrixSize + j] = B.back()->data[i][j];
+      }
+    }
+  }
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (uint32_t b = 0; b < batchCount; ++b) {
+    MultiplyMatrices(*A[b], *B[b], *C[b], matrixSize);
+  }
+  const long perCallUs = Microseconds(start);
+  std::printf("per call duration = %ld microseconds\n", perCallUs);
+
+  std::vector<std::unique_ptr<Matrix>> batchedC;
+  for (uint32_t b = 0; b < batchCount; ++b) {
+    batchedC.emplace_back(new Matrix(matrixSize));
+    pointersC[b] = batchedC.back().get();
+  }
+  start = std::chrono::high_resolution_clock::now();
+  MultiplyBatched(pointersA.data(), pointersB.data(), pointersC.data(), matrixSize, batchCount);
+  std::printf("batched duration = %ld microseconds\n", Microseconds(start));
+
+  start = std::chrono::high_resolution_clock::now();
+  MultiplyStridedBatched(stridedA.data(), stride, stridedB.data(), stride, stridedC.data(), stride, matrixSize,
+                         batchCount);
+  const long stridedUs = Microseconds(start);
+  std::printf("strided duration = %ld microseconds\n", stridedUs);
+
+  start = std::chrono::high_resolution_clock::now();
+  RunBlocks<BatchTaskData>(&MultiplyStridedBatchBlock<0>, batchCount, 0,
+                           [&](const uint32_t inStart, const uint32_t inEnd) {
+                             return BatchTaskData{NULL, NULL, NULL, stridedA.data(), stridedB.data(), genericC.data(),
+                                                  stride, stride, stride, matrixSize, inStart, inEnd};
+                           });
+  std::printf("strided runtime-size kernel duration = %ld microseconds\n", Microseconds(start));
+
+  bool matches = true;
+  for (uint32_t b = 0; b < batchCount && matches; ++b) {
+    matches &= MatricesEqual(*C[b], *batchedC[b]);
+    for (uint16_t i = 0; i < matrixSize; ++i) {
+      for (uint16_t j = 0; j < matrixSize; ++j) {
+        matches &= (stridedC[b * stride + i * matrixSize + j] == C[b]->data[i][j]) &&
+                   (genericC[b * stride + i * matrixSize + j] == C[b]->data[i][j]);
+      }
+    }
+  }
+  std::printf("%u multiplies of %ux%u, strided batch %.1fx faster than per call, results %s\n", batchCount,
+              matrixSize, matrixSize, stridedUs ? static_cast<double>(perCallUs) / stridedUs : 0.0,
+              matches ? "match" : "DIFFER");
+  return matches ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+#ifndef BATCHED_MATRIX_H
+#define BATCHED_MATRIX_H
+
+#include <cstdint>
+
+#include "matrix_multiply.h"
+
+// Many independent small multiplies, C[b] += A[b] B[b] for every b of a batch, on one pool for the whole
+// batch: the pool's tasks are blocks of the batch, not rows of one product, so a batch of 8x8 multiplies
+// costs one pool start-up rather than one per multiply. The batch is either arrays of Matrix pointers or
+// strided: every matrix size * size ints in row-major order, matrix b at base + b * stride.
+//
+// The kernel is picked once per batch. For 8, 16, 32, 64 and 128 it is instantiated for that size, so every
+// trip count is a constant and the compiler unrolls the loops and keeps a row of C in registers; other
+// sizes take the same loops with runtime bounds.
+
+// Rows of a strided matrix, indexed like the int** rows of Matrix
+template <typename T>
+struct StridedRows {
+  T* operator[](const uint16_t inRow) const { return fBase + static_cast<std::size_t>(inRow) * fSize; }
+  T* fBase;
+  uint16_t fSize;
+};
+
+// C += A B for Size x Size matrices; Size 0 takes inSize at runtime. A fixed size sums each row of C in a
+// local array the compiler can keep in registers, and stores it once.
+template <uint16_t Size, typename RowsA, typename RowsB, typename RowsC>
+inline void MultiplySmall(const RowsA& A, const RowsB& B, const RowsC& C, const uint16_t inSize) {
+  if constexpr (Size > 0) {
+    for (uint16_t i = 0; i < Size; ++i) {
+      const int* aRowA = A[i];
+      int aSums[Size] = {0};
+      for (uint16_t k = 0; k < Size; ++k) {
+        const int aValue = aRowA[k];
+        const int* aRowB = B[k];
+        for (uint16_t j = 0; j < Size; ++j) {
+          aSums[j] += aValue * aRowB[j];
+        }
+      }
+      int* aRowC = C[i];
+      for (uint16_t j = 0; j < Size; ++j) {
+        aRowC[j] += aSums[j];
+      }
+    }
+    return;
+  }
+  const uint16_t aSize = inSize;
+  for (uint16_t i = 0; i < aSize; ++i) {
+    const int* aRowA = A[i];
+    int* aRowC = C[i];
+    for (uint16_t k = 0; k < aSize; ++k) {
+      const int aValue = aRowA[k];
+      const int* aRowB = B[k];
+      for (uint16_t j = 0; j < aSize; ++j) {
+        aRowC[j] += aValue * aRowB[j];
+      }
+    }
+  }
+}
+
+typedef struct BatchTaskData {
+  const Matrix* const* fMatricesA; // Matrix pointer batch, or NULL for a strided one
+  const Matrix* const* fMatricesB;
+  Matrix* const* fMatricesC;
+  const int* fStridedA;
+  const int* fStridedB;
+  int* fStridedC;
+  const std::size_t fStrideA;
+  const std::size_t fStrideB;
+  const std::size_t fStrideC;
+  const uint16_t fSize;
+  const uint32_t fStart;
+  const uint32_t fEnd;
+} BatchTaskData;
+
+template <uint16_t Size>
+void* MultiplyBatchBlock(void* args) {
+  BatchTaskData* aTask = static_cast<BatchTaskData*>(args);
+  for (uint32_t b = aTask->fStart; b < aTask->fEnd; ++b) {
+    MultiplySmall<Size>(aTask->fMatricesA[b]->data, aTask->fMatricesB[b]->data, aTask->fMatricesC[b]->data,
+                        aTask->fSize);
+  }
+  return NULL;
+}
+
+template <uint16_t Size>
+void* MultiplyStridedBatchBlock(void* args) {
+  BatchTaskData* aTask = static_cast<BatchTaskData*>(args);
+  for (uint32_t b = aTask->fStart; b < aTask->fEnd; ++b) {
+    MultiplySmall<Size>(StridedRows<const int>{aTask->fStridedA + b * aTask->fStrideA, aTask->fSize},
+                        StridedRows<const int>{aTask->fStridedB + b * aTask->fStrideB, aTask->fSize},
+                        StridedRows<int>{aTask->fStridedC + b * aTask->fStrideC, aTask->fSize}, aTask->fSize);
+  }
+  return NULL;
+}
+
+inline TaskFn BatchKernel(const uint16_t inSize, const bool inStrided) {
+  switch (inSize) {
+    case 8:
+      return inStrided ? &MultiplyStridedBatchBlock<8> : &MultiplyBatchBlock<8>;
+    case 16:
+      return inStrided ? &MultiplyStridedBatchBlock<16> : &MultiplyBatchBlock<16>;
+    case 32:
+      return inStrided ? &MultiplyStridedBatchBlock<32> : &MultiplyBatchBlock<32>;
+    case 64:
+      return inStrided ? &MultiplyStridedBatchBlock<64> : &MultiplyBatchBlock<64>;
+    case 128:
+      return inStrided ? &MultiplyStridedBatchBlock<128> : &MultiplyBatchBlock<128>;
+    default:
+      return inStrided ? &MultiplyStridedBatchBlock<0> : &MultiplyBatchBlock<0>;
+  }
+}
+
+// C[b] += A[b] B[b] for b < inCount; every matrix is inSize x inSize
+inline void MultiplyBatched(const Matrix* const* A, const Matrix* const* B, Matrix* const* C, const uint16_t inSize,
+                            const uint32_t inCount, const uint16_t inMaxThreads = 0) {
+  RunBlocks<BatchTaskData>(BatchKernel(inSize, false), inCount, inMaxThreads,
+                           [&](const uint32_t inStart, const uint32_t inEnd) {
+                             return BatchTaskData{A, B, C, NULL, NULL, NULL, 0, 0, 0, inSize, inStart, inEnd};
+                           });
+}
+
+// As MultiplyBatched, matrix b of each operand at base + b * stride (in ints, at least inSize * inSize)
+inline void MultiplyStridedBatched(const int* A, const std::size_t inStrideA, const int* B, const std::size_t inStrideB,
+                                   int* C, const std::size_t inStrideC, const uint16_t inSize, const uint32_t inCount,
+                                   const uint16_t inMaxThreads = 0) {
+  RunBlocks<BatchTaskData>(BatchKernel(inSize, true), inCount, inMaxThreads,
+                           [&](const uint32_t inStart, const uint32_t inEnd) {
+                             return BatchTaskData{NULL, NULL, NULL, A, B, C, inStrideA, inStrideB, inStrideC,
+                                                  inSize, inStart, inEnd};
+                           });
+}
+
+#endif // BATCHED_MATRIX_H
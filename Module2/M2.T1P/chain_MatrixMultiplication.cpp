@@ -0,0 +1,79 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "matrix_chain.h"
+
+// Multiplies a chain of random rectangular matrices left to right and in the FLOP-optimal order, twice
+// with the same arena to show its buffers being reused, and reports the FLOPs each order takes and saves
+// and whether the products agree.
+//
+// Usage: chain_multiplication.o [d0 d1 ... dn], matrix i being d(i-1) x di
+
+static long Microseconds(const std::chrono::high_resolution_clock::time_point inStart) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - inStart)
+    .count();
+}
+
+int main(int argc, char** argv) {
+  std::vector<uint16_t> dimensions{400, 20, 600, 30, 500, 10, 700, 40, 300};
+  if (argc > 2) {
+    dimensions.clear();
+    for (int n = 1; n < argc; ++n) {
+      dimensions.push_back(atoi(argv[n]));
+    }
+  }
+  const uint16_t chainLength = dimensions.size() - 1;
+
+  std::random_device device;
+  std::mt19937 rng(device());
+  std::uniform_int_distribution<int> distribution(-2, 2);
+  std::vector<std::vector<int>> storage;
+  std::vector<ChainMatrix> chain;
+  for (uint16_t n = 0; n < chainLength; ++n) {
+    storage.emplace_back(static_cast<std::size_t>(dimensions[n]) * dimensions[n + 1]);
+    for (int& aEntry : storage.back()) {
+      aEntry = distribution(rng);
+    }
+    chain.push_back({dimensions[n], dimensions[n + 1], storage.back().data()});
+  }
+  const std::size_t resultEntries = static_cast<std::size_t>(dimensions.front()) * dimensions.back();
+  std::vector<int> leftToRightC(resultEntries), optimalC(resultEntries), reusedC(resultEntries);
+
+  const ChainPlan leftToRight = LeftToRightPlan(dimensions);
+  auto start = std::chrono::high_resolution_clock::now();
+  const ChainPlan optimal = PlanChain(dimensions);
+  std::printf("plan duration = %ld microseconds\n", Microseconds(start));
+
+  ChainArena leftToRightArena;
+  start = std::chrono::high_resolution_clock::now();
+  MultiplyChain(chain, leftToRight, {dimensions.front(), dimensions.back(), leftToRightC.data()}, leftToRightArena);
+  const long leftToRightUs = Microseconds(start);
+  std::printf("left to right duration = %ld microseconds\n", leftToRightUs);
+
+  ChainArena arena;
+  start = std::chrono::high_resolution_clock::now();
+  MultiplyChain(chain, optimal, {dimensions.front(), dimensions.back(), optimalC.data()}, arena);
+  const long optimalUs = Microseconds(start);
+  std::printf("optimal duration = %ld microseconds\n", optimalUs);
+  const std::size_t firstAllocations = arena.fAllocations;
+
+  start = std::chrono::high_resolution_clock::now();
+  MultiplyChain(chain, optimal, {dimensions.front(), dimensions.back(), reusedC.data()}, arena);
+  std::printf("optimal reused arena duration = %ld microseconds\n", Microseconds(start));
+
+  const bool matches = leftToRightC == optimalC && optimalC == reusedC;
+  std::printf("%u matrices, left to right %s = %.1f MFLOP, optimal %s = %.1f MFLOP\n", chainLength,
+              ChainOrder(leftToRight).c_str(), leftToRight.fFlops / 1e6, ChainOrder(optimal).c_str(),
+              optimal.fFlops / 1e6);
+  std::printf("saved %.1f MFLOP (%.1f%%), %.1fx faster, arena %zu bytes in %zu allocations (%zu on reuse), "
+              "results %s\n",
+              (leftToRight.fFlops - optimal.fFlops) / 1e6,
+              leftToRight.fFlops ? 100.0 * (leftToRight.fFlops - optimal.fFlops) / leftToRight.fFlops : 0.0,
+              optimalUs ? static_cast<double>(leftToRightUs) / optimalUs : 0.0, arena.Bytes(), firstAllocations,
+              arena.fAllocations - firstAllocations, matches ? "match" : "DIFFER");
+  return matches ? 0 : 1;
+}
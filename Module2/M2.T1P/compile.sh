@@ -3,3 +3,8 @@
 g++ sequential_MatrixMultiplication.cpp -o sequential_multiplication.o
 g++ pthreads_MatrixMultiplication.cpp -pthread --std=c++17 -o pthread_multiplication.o
 g++ openmp_MatrixMultiplication.cpp -fopenmp -o omp_multiplication.o
+g++ sparse_MatrixMultiplication.cpp -pthread --std=c++17 -O2 -o sparse_multiplication.o
+g++ batched_MatrixMultiplication.cpp -pthread --std=c++17 -O3 -o batched_multiplication.o
+g++ gemm_MatrixMultiplication.cpp -pthread --std=c++17 -O3 -o gemm_multiplication.o
+g++ fixed_MatrixMultiplication.cpp -pthread --std=c++17 -O3 -o fixed_multiplication.o
+g++ chain_MatrixMultiplication.cpp -pthread --std=c++17 -O3 -fwrapv -o chain_multiplication.o
@@ -0,0 +1,84 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "batched_matrix.h"
+#include "fixed_matrix.h"
+#include "gemm.h"
+
+// Multiplies many 4x4 and 16x16 FixedMatrix pairs against the runtime-size kernel on the same data, then a
+// dynamic Matrix through 16x16 and 64x64 fixed tiles against Gemm, checking every result.
+//
+// Usage: fixed_multiplication.o [matrixSize] [repetitions]
+
+static long Microseconds(const std::chrono::high_resolution_clock::time_point inStart) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - inStart)
+    .count();
+}
+
+// Sums repetitions products of Size x Size matrices, fixed and through the runtime-size kernel
+template <uint16_t Size>
+static bool CompareSmall(const uint32_t repetitions) {
+  Matrix A(Size);
+  Matrix B(Size);
+  GenerateMatrices(A, B);
+  FixedMatrix<int, Size, Size> fixedA;
+  FixedMatrix<int, Size, Size> fixedB;
+  fixedA.Load({A.data, 0, 0});
+  fixedB.Load({B.data, 0, 0});
+
+  auto start = std::chrono::high_resolution_clock::now();
+  FixedMatrix<int, Size, Size> fixedSum{};
+  for (uint32_t r = 0; r < repetitions; ++r) {
+    fixedSum.MultiplyAdd(fixedA, fixedB);
+    fixedA.data[r % Size][r % Size] ^= 1; // keeps the products from being hoisted out of the loop
+  }
+  const long fixedUs = Microseconds(start);
+
+  fixedA.Load({A.data, 0, 0});
+  Matrix runtimeSum(Size);
+  start = std::chrono::high_resolution_clock::now();
+  for (uint32_t r = 0; r < repetitions; ++r) {
+    MultiplySmall<0>(A.data, B.data, runtimeSum.data, Size);
+    A.data[r % Size][r % Size] ^= 1;
+  }
+  const long runtimeUs = Microseconds(start);
+
+  bool matches = true;
+  for (uint16_t i = 0; i < Size; ++i) {
+    for (uint16_t j = 0; j < Size; ++j) {
+      matches &= (fixedSum(i, j) == runtimeSum.data[i][j]);
+    }
+  }
+  std::printf("%ux%u: fixed duration = %ld microseconds, runtime-size duration = %ld microseconds, %u products\n",
+              Size, Size, fixedUs, runtimeUs, repetitions);
+  return matches;
+}
+
+int main(int argc, char** argv) {
+  const uint16_t matrixSize = (argc > 1 ? atoi(argv[1]) : 1000);
+  const uint32_t repetitions = (argc > 2 ? strtoul(argv[2], NULL, 10) : 1000000);
+  bool matches = CompareSmall<4>(repetitions) && CompareSmall<16>(repetitions / 64);
+
+  Matrix A(matrixSize);
+  Matrix B(matrixSize);
+  Matrix gemmC(matrixSize, false);
+  Matrix tiled16C(matrixSize);
+  Matrix tiled64C(matrixSize);
+  GenerateMatrices(A, B);
+  auto start = std::chrono::high_resolution_clock::now();
+  Gemm(noTranspose, noTranspose, 1, A, B, 0, gemmC);
+  std::printf("gemm duration = %ld microseconds\n", Microseconds(start));
+  start = std::chrono::high_resolution_clock::now();
+  MultiplyTiled<16>(A, B, tiled16C);
+  std::printf("16x16 tiles duration = %ld microseconds\n", Microseconds(start));
+  start = std::chrono::high_resolution_clock::now();
+  MultiplyTiled<64>(A, B, tiled64C);
+  std::printf("64x64 tiles duration = %ld microseconds\n", Microseconds(start));
+  matches &= MatricesEqual(gemmC, tiled16C) && MatricesEqual(gemmC, tiled64C);
+
+  std::printf("results %s\n", matches ? "match" : "DIFFER");
+  return matches ? 0 : 1;
+}
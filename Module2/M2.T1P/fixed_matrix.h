@@ -0,0 +1,153 @@
+#ifndef FIXED_MATRIX_H
+#define FIXED_MATRIX_H
+
+#include <cstdint>
+#include <utility>
+
+#include "matrix_multiply.h"
+
+// FixedMatrix<T, Rows, Columns> is a matrix whose shape is part of its type, stored inline (on the stack, or
+// in whatever holds it), for the hot fixed shapes. Its multiply has no runtime bounds: the loops over rows
+// and the inner dimension have constant trip counts, and each row update is expanded at compile time into
+// one statement per column, so the compiler can keep a 4x4 or a row of a 16x16 tile in registers.
+//
+// MatrixView is a window onto the rows of a dynamic Matrix (or anything with T** rows) at a row and column
+// offset, through which fixed tiles are loaded from and added to it. MultiplyTiled multiplies dynamic
+// matrices that way, Tile x Tile blocks at a time on the pool: tiles of A are copied in, tiles of B are read
+// in place through a view; the ragged margins of a size that is not a multiple of Tile take plain loops.
+
+template <typename T>
+struct MatrixView {
+  T* Row(const uint16_t inRow) const { return fRows[fRow + inRow] + fColumn; }
+  T* const* fRows;
+  uint16_t fRow;
+  uint16_t fColumn;
+};
+
+template <typename T, uint16_t Rows, uint16_t Columns>
+struct FixedMatrix {
+  T& operator()(const uint16_t inRow, const uint16_t inColumn) { return data[inRow][inColumn]; }
+  const T& operator()(const uint16_t inRow, const uint16_t inColumn) const { return data[inRow][inColumn]; }
+
+  void Load(const MatrixView<const T>& inView) {
+    for (uint16_t i = 0; i < Rows; ++i) {
+      const T* aRow = inView.Row(i);
+      for (uint16_t j = 0; j < Columns; ++j) {
+        data[i][j] = aRow[j];
+      }
+    }
+  }
+
+  void AddTo(const MatrixView<T>& outView) const {
+    for (uint16_t i = 0; i < Rows; ++i) {
+      T* aRow = outView.Row(i);
+      for (uint16_t j = 0; j < Columns; ++j) {
+        aRow[j] += data[i][j];
+      }
+    }
+  }
+
+  // this += A B. Each row is summed in a local copy, which A and B cannot alias, so it can stay in registers.
+  template <uint16_t Inner>
+  void MultiplyAdd(const FixedMatrix<T, Rows, Inner>& A, const FixedMatrix<T, Inner, Columns>& B) {
+    MultiplyAdd(A, [&](const uint16_t inRow) { return B.data[inRow]; });
+  }
+
+  // this += A B for the Inner x Columns block of B seen through inView, read in place
+  template <uint16_t Inner>
+  void MultiplyAdd(const FixedMatrix<T, Rows, Inner>& A, const MatrixView<const T>& inView) {
+    MultiplyAdd(A, [&](const uint16_t inRow) { return inView.Row(inRow); });
+  }
+
+  template <uint16_t Inner, typename RowOfB>
+  void MultiplyAdd(const FixedMatrix<T, Rows, Inner>& A, const RowOfB& inRowOfB) {
+    for (uint16_t i = 0; i < Rows; ++i) {
+      FixedMatrix<T, 1, Columns> aRow = Slice(i);
+      for (uint16_t k = 0; k < Inner; ++k) {
+        AddScaledRow(aRow.data[0], A.data[i][k], inRowOfB(k), std::make_integer_sequence<uint16_t, Columns>());
+      }
+      for (uint16_t j = 0; j < Columns; ++j) {
+        data[i][j] = aRow.data[0][j];
+      }
+    }
+  }
+
+  FixedMatrix<T, 1, Columns> Slice(const uint16_t inRow) const {
+    FixedMatrix<T, 1, Columns> aRow;
+    for (uint16_t j = 0; j < Columns; ++j) {
+      aRow.data[0][j] = data[inRow][j];
+    }
+    return aRow;
+  }
+
+  template <uint16_t... Column>
+  static void AddScaledRow(T* outRow, const T inScale, const T* inRow, std::integer_sequence<uint16_t, Column...>) {
+    ((outRow[Column] += inScale * inRow[Column]), ...);
+  }
+
+  T data[Rows][Columns];
+};
+
+template <typename T, uint16_t Rows, uint16_t Inner, uint16_t Columns>
+FixedMatrix<T, Rows, Columns> operator*(const FixedMatrix<T, Rows, Inner>& A, const FixedMatrix<T, Inner, Columns>& B) {
+  FixedMatrix<T, Rows, Columns> aProduct{};
+  aProduct.MultiplyAdd(A, B);
+  return aProduct;
+}
+
+// C[i][j] += sum over k of A[i][k] B[k][j] for i, j and k in the given ranges
+inline void MultiplyRange(const Matrix& A, const Matrix& B, Matrix& C, const uint16_t inRowStart,
+                          const uint16_t inRowEnd, const uint16_t inColumnStart, const uint16_t inColumnEnd,
+                          const uint16_t inInnerStart, const uint16_t inInnerEnd) {
+  for (uint16_t i = inRowStart; i < inRowEnd; ++i) {
+    for (uint16_t k = inInnerStart; k < inInnerEnd; ++k) {
+      const int aValue = A.data[i][k];
+      for (uint16_t j = inColumnStart; j < inColumnEnd; ++j) {
+        C.data[i][j] += aValue * B.data[k][j];
+      }
+    }
+  }
+}
+
+// A task's fStart and fEnd count rows of tiles; the task that reaches the last tile row also takes the
+// rows below it
+template <uint16_t Tile>
+void* MultiplyTileRows(void* args) {
+  TaskData* aTask = static_cast<TaskData*>(args);
+  const Matrix& A = aTask->fMatrixA;
+  const Matrix& B = aTask->fMatrixB;
+  Matrix& C = aTask->fMatrixC;
+  const uint16_t aTiled = C.size / Tile * Tile;
+  for (uint16_t aTileRow = aTask->fStart; aTileRow < aTask->fEnd; ++aTileRow) {
+    const uint16_t i = aTileRow * Tile;
+    for (uint16_t j = 0; j < aTiled; j += Tile) {
+      FixedMatrix<int, Tile, Tile> aSum{};
+      for (uint16_t k = 0; k < aTiled; k += Tile) {
+        FixedMatrix<int, Tile, Tile> aTileA;
+        aTileA.Load({A.data, i, k});
+        aSum.MultiplyAdd(aTileA, MatrixView<const int>{B.data, k, j});
+      }
+      aSum.AddTo({C.data, i, j});
+    }
+    MultiplyRange(A, B, C, i, i + Tile, 0, aTiled, aTiled, C.size);
+    MultiplyRange(A, B, C, i, i + Tile, aTiled, C.size, 0, C.size);
+  }
+  if (aTask->fEnd == aTiled / Tile) {
+    MultiplyRange(A, B, C, aTiled, C.size, 0, C.size, 0, C.size);
+  }
+  return NULL;
+}
+
+// C += A B through Tile x Tile fixed tiles
+template <uint16_t Tile>
+void MultiplyTiled(const Matrix& A, const Matrix& B, Matrix& C, const uint16_t inMaxThreads = 0) {
+  const uint16_t aTileRows = C.size / Tile;
+  if (!aTileRows) {
+    MultiplyRange(A, B, C, 0, C.size, 0, C.size, 0, C.size);
+    return;
+  }
+  RunBlocks<TaskData>(&MultiplyTileRows<Tile>, aTileRows, inMaxThreads,
+                      [&](const uint16_t inStart, const uint16_t inEnd) { return TaskData(A, B, C, inStart, inEnd); });
+}
+
+#endif // FIXED_MATRIX_H
@@ -0,0 +1,91 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "matrix_multiply.h"
+
+// BLAS-style C = alpha op(A) op(B) + beta C, op(X) being X or its transpose, on the pool one block of rows
+// of C per task. The transposes are taken by indexing, not by copying a matrix: row i of op(B) = B^T is
+// read as the dot products of op(A)'s row against the rows of B, and row i of A^T is gathered from column
+// i of A into the task's row buffer. Each row of C is summed in that buffer and written once, scaled, so
+// beta = 0 overwrites C without reading it: C needs no zero-filling (Matrix(size, false)) and may hold
+// anything, and scaling and adding fuse into the same pass. C must not be A or B.
+
+enum Transpose : uint8_t { noTranspose, transpose };
+
+typedef struct GemmTaskData {
+  const Transpose fTransposeA;
+  const Transpose fTransposeB;
+  const int fAlpha;
+  const int fBeta;
+  const Matrix& fMatrixA;
+  const Matrix& fMatrixB;
+  Matrix& fMatrixC;
+  const uint16_t fStart;
+  const uint16_t fEnd;
+} GemmTaskData;
+
+inline void* GemmRows(void* args) {
+  GemmTaskData* aTask = static_cast<GemmTaskData*>(args);
+  const Matrix& A = aTask->fMatrixA;
+  const Matrix& B = aTask->fMatrixB;
+  Matrix& C = aTask->fMatrixC;
+  const uint16_t aSize = C.size;
+  std::vector<int> aColumnA(aTask->fTransposeA == transpose ? aSize : 0);
+  std::vector<int> aSums(aSize);
+  for (uint16_t i = aTask->fStart; i < aTask->fEnd; ++i) {
+    const int* aRowA = A.data[i];
+    if (aTask->fTransposeA == transpose) {
+      for (uint16_t k = 0; k < aSize; ++k) {
+        aColumnA[k] = A.data[k][i];
+      }
+      aRowA = aColumnA.data();
+    }
+
+    if (aTask->fTransposeB == transpose) {
+      for (uint16_t j = 0; j < aSize; ++j) {
+        const int* aRowB = B.data[j];
+        int aSum = 0;
+        for (uint16_t k = 0; k < aSize; ++k) {
+          aSum += aRowA[k] * aRowB[k];
+        }
+        aSums[j] = aSum;
+      }
+    } else {
+      std::fill(aSums.begin(), aSums.end(), 0);
+      for (uint16_t k = 0; k < aSize; ++k) {
+        const int aValue = aRowA[k];
+        const int* aRowB = B.data[k];
+        for (uint16_t j = 0; j < aSize; ++j) {
+          aSums[j] += aValue * aRowB[j];
+        }
+      }
+    }
+
+    int* aRowC = C.data[i];
+    const int aAlpha = aTask->fAlpha;
+    const int aBeta = aTask->fBeta;
+    if (!aBeta) {
+      for (uint16_t j = 0; j < aSize; ++j) {
+        aRowC[j] = aAlpha * aSums[j];
+      }
+    } else {
+      for (uint16_t j = 0; j < aSize; ++j) {
+        aRowC[j] = aAlpha * aSums[j] + aBeta * aRowC[j];
+      }
+    }
+  }
+  return NULL;
+}
+
+inline void Gemm(const Transpose transA, const Transpose transB, const int alpha, const Matrix& A, const Matrix& B,
+                 const int beta, Matrix& C, const uint16_t inMaxThreads = 0) {
+  RunBlocks<GemmTaskData>(&GemmRows, C.size, inMaxThreads, [&](const uint16_t inStart, const uint16_t inEnd) {
+    return GemmTaskData{transA, transB, alpha, beta, A, B, C, inStart, inEnd};
+  });
+}
+
+#endif // GEMM_H
@@ -0,0 +1,79 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+#include "gemm.h"
+
+// Times Gemm overwriting an uninitialised C (beta = 0) against accumulating into a zero-filled one, both
+// including C's allocation, then checks every transpose combination and a fused C = alpha A B + beta C
+// against references built from explicit transposed copies and the dense pool multiply.
+//
+// Usage: gemm_multiplication.o [matrixSize]
+
+static long Microseconds(const std::chrono::high_resolution_clock::time_point inStart) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - inStart)
+    .count();
+}
+
+static void Transposed(const Matrix& inMatrix, Matrix& outMatrix) {
+  for (uint16_t i = 0; i < inMatrix.size; ++i) {
+    for (uint16_t j = 0; j < inMatrix.size; ++j) {
+      outMatrix.data[j][i] = inMatrix.data[i][j];
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  const uint16_t matrixSize = (argc > 1 ? atoi(argv[1]) : 1000);
+  Matrix A(matrixSize);
+  Matrix B(matrixSize);
+  GenerateMatrices(A, B);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  {
+    Matrix C(matrixSize);
+    Gemm(noTranspose, noTranspose, 1, A, B, 1, C);
+  }
+  std::printf("zero-filled C, beta = 1 duration = %ld microseconds\n", Microseconds(start));
+  start = std::chrono::high_resolution_clock::now();
+  {
+    Matrix C(matrixSize, false);
+    Gemm(noTranspose, noTranspose, 1, A, B, 0, C);
+  }
+  std::printf("uninitialised C, beta = 0 duration = %ld microseconds\n", Microseconds(start));
+
+  Matrix transposedA(matrixSize);
+  Matrix transposedB(matrixSize);
+  Transposed(A, transposedA);
+  Transposed(B, transposedB);
+  bool matches = true;
+  for (const Transpose transA : {noTranspose, transpose}) {
+    for (const Transpose transB : {noTranspose, transpose}) {
+      Matrix expected(matrixSize);
+      MultiplyMatrices(transA ? transposedA : A, transB ? transposedB : B, expected, matrixSize);
+      Matrix C(matrixSize, false);
+      start = std::chrono::high_resolution_clock::now();
+      Gemm(transA, transB, 1, A, B, 0, C);
+      std::printf("gemm %c%c duration = %ld microseconds\n", transA ? 'T' : 'N', transB ? 'T' : 'N',
+                  Microseconds(start));
+      matches &= MatricesEqual(C, expected);
+    }
+  }
+
+  // C = 2 A B - 3 C in one pass over C
+  Matrix C(matrixSize);
+  Matrix expected(matrixSize);
+  GenerateMatrixData(C);
+  MultiplyMatrices(A, B, expected, matrixSize);
+  for (uint16_t i = 0; i < matrixSize; ++i) {
+    for (uint16_t j = 0; j < matrixSize; ++j) {
+      expected.data[i][j] = 2 * expected.data[i][j] - 3 * C.data[i][j];
+    }
+  }
+  Gemm(noTranspose, noTranspose, 2, A, B, -3, C);
+  matches &= MatricesEqual(C, expected);
+
+  std::printf("results %s\n", matches ? "match" : "DIFFER");
+  return matches ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+// The dense square Matrix of the multiply programs, rows allocated separately. The rows are zero-filled
+// unless inZeroed is false, for a matrix that is written before it is read (the C of Gemm with beta = 0).
+
+typedef struct Matrix {
+  Matrix() = default;
+  Matrix(const uint16_t matrixSize, const bool inZeroed = true) : size(matrixSize) {
+    data = new int*[size];
+    for (uint16_t i = 0; i < size; ++i) {
+      data[i] = (inZeroed ? new int[size] {0} : new int[size]);
+    }
+  }
+
+  ~Matrix() {
+    for (uint16_t i = 0; i < size; ++i) {
+      delete[] data[i];
+    }
+    delete[] data;
+  }
+
+  void Print() {
+    for (uint16_t i = 0; i < size; ++i) {
+      for (uint16_t j = 0; j < size; ++j) {
+        std::printf("%u ", data[i][j]);
+      }
+      std::printf("\n");
+    }
+  }
+  const uint16_t size;
+  int** data;
+} Matrix;
+
+inline void GenerateMatrixData(Matrix& inMatrix) {
+  std::random_device device;
+  std::mt19937 rng(device());
+  std::uniform_int_distribution<uint8_t> distribution(0, 100);
+  for (uint16_t i = 0; i < inMatrix.size; ++i) {
+    for (uint16_t j = 0; j < inMatrix.size; ++j) {
+      inMatrix.data[i][j] = distribution(rng);
+    }
+  }
+}
+
+inline void GenerateMatrices(Matrix& A, Matrix& B) {
+  GenerateMatrixData(A);
+  GenerateMatrixData(B);
+}
+
+// Each entry non-zero (1-100) with probability inDensity
+inline void GenerateSparseMatrixData(Matrix& inMatrix, const double inDensity) {
+  std::random_device device;
+  std::mt19937 rng(device());
+  std::bernoulli_distribution present(inDensity);
+  std::uniform_int_distribution<uint8_t> distribution(1, 100);
+  for (uint16_t i = 0; i < inMatrix.size; ++i) {
+    for (uint16_t j = 0; j < inMatrix.size; ++j) {
+      inMatrix.data[i][j] = present(rng) ? distribution(rng) : 0;
+    }
+  }
+}
+
+inline bool MatricesEqual(const Matrix& A, const Matrix& B) {
+  if (A.size != B.size)
+    return false;
+  for (uint16_t i = 0; i < A.size; ++i) {
+    for (uint16_t j = 0; j < A.size; ++j) {
+      if (A.data[i][j] != B.data[i][j])
+        return false;
+    }
+  }
+  return true;
+}
+
+#endif // MATRIX_H
@@ -0,0 +1,266 @@
+#ifndef MATRIX_CHAIN_H
+#define MATRIX_CHAIN_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "matrix_multiply.h"
+
+// The product of a chain of rectangular matrices, M1 M2 ... Mn with Mi of dimensions[i - 1] x dimensions[i].
+// Every association order gives the same product, but the cost of a multiply is rows * inner * columns, so
+// the order decides the work: (10x1000 1000x10) 10x1000 is 0.4 MFLOP, 10x1000 (1000x10 10x1000) is 40.
+// PlanChain finds the order with the fewest FLOPs by the usual dynamic programme over subchains, O(n^3) in
+// the chain length, which is nothing next to the multiplies for the 5-20 matrices of a pipeline.
+//
+// MultiplyChain runs a plan as a tree of subproducts. A subproduct's height is one more than its taller
+// operand's, so the subproducts of the same height never depend on each other: each height is one pool, its
+// tasks blocks of rows of every subproduct of that height, so independent subproducts run side by side and
+// a lone large one still spreads over the threads. The intermediates live in a ChainArena: their buffers
+// are returned once the subproduct that reads them is done and handed out again to later ones, and the
+// arena can be kept from one chain to the next, so a pipeline that repeats its chain stops allocating once
+// the arena has grown to fit it (after the first run or two, the buffers being reused in a different order).
+//
+// Entries are int, as everywhere here. A long chain of products overflows it; the results still agree
+// from one order to another if the program is built with -fwrapv.
+
+// A rows x columns matrix in row-major order, in memory owned by someone else: the caller for the links and
+// result of a chain, the arena for intermediates
+typedef struct ChainMatrix {
+  int* Row(const uint16_t inRow) const { return data + static_cast<std::size_t>(inRow) * columns; }
+  std::size_t Entries() const { return static_cast<std::size_t>(rows) * columns; }
+  uint16_t rows;
+  uint16_t columns;
+  int* data;
+} ChainMatrix;
+
+// FLOPs (a multiply and an add per term) of a rows x inner times inner x columns product
+inline uint64_t ProductFlops(const uint16_t inRows, const uint16_t inInner, const uint16_t inColumns) {
+  return 2 * static_cast<uint64_t>(inRows) * inInner * inColumns;
+}
+
+// An association order for a chain of fDimensions.size() - 1 matrices. Matrices are numbered from 0; the
+// subchain [i, j] is split into [i, Split(i, j)] and [Split(i, j) + 1, j].
+typedef struct ChainPlan {
+  uint16_t Length() const { return fDimensions.size() - 1; }
+  uint16_t Split(const uint16_t inFirst, const uint16_t inLast) const { return fSplits[inFirst * Length() + inLast]; }
+
+  std::vector<uint16_t> fDimensions;
+  std::vector<uint16_t> fSplits; // Length() x Length(), entry [i][j] for i < j
+  uint64_t fFlops;
+} ChainPlan;
+
+// The FLOP-optimal order for matrices of inDimensions[i] x inDimensions[i + 1]
+inline ChainPlan PlanChain(const std::vector<uint16_t>& inDimensions) {
+  const uint16_t aLength = inDimensions.size() - 1;
+  ChainPlan aPlan{inDimensions, std::vector<uint16_t>(aLength * aLength, 0), 0};
+  // aCosts[i][j]: fewest FLOPs for the subchain [i, j], filled by increasing subchain length
+  std::vector<uint64_t> aCosts(aLength * aLength, 0);
+  for (uint16_t aSpan = 1; aSpan < aLength; ++aSpan) {
+    for (uint16_t i = 0; i + aSpan < aLength; ++i) {
+      const uint16_t j = i + aSpan;
+      uint64_t aBest = UINT64_MAX;
+      for (uint16_t k = i; k < j; ++k) {
+        const uint64_t aCost = aCosts[i * aLength + k] + aCosts[(k + 1) * aLength + j] +
+                               ProductFlops(inDimensions[i], inDimensions[k + 1], inDimensions[j + 1]);
+        if (aCost < aBest) {
+          aBest = aCost;
+          aPlan.fSplits[i * aLength + j] = k;
+        }
+      }
+      aCosts[i * aLength + j] = aBest;
+    }
+  }
+  aPlan.fFlops = (aLength > 1 ? aCosts[aLength - 1] : 0);
+  return aPlan;
+}
+
+// ((M1 M2) M3) ...: every subchain [0, j] split before its last matrix
+inline ChainPlan LeftToRightPlan(const std::vector<uint16_t>& inDimensions) {
+  const uint16_t aLength = inDimensions.size() - 1;
+  ChainPlan aPlan{inDimensions, std::vector<uint16_t>(aLength * aLength, 0), 0};
+  for (uint16_t j = 1; j < aLength; ++j) {
+    aPlan.fSplits[j] = j - 1;
+    aPlan.fFlops += ProductFlops(inDimensions[0], inDimensions[j], inDimensions[j + 1]);
+  }
+  return aPlan;
+}
+
+// The plan's order written out, as in ((M1 M2) M3)
+inline std::string ChainOrder(const ChainPlan& inPlan, const uint16_t inFirst, const uint16_t inLast) {
+  if (inFirst == inLast)
+    return "M" + std::to_string(inFirst + 1);
+  const uint16_t aSplit = inPlan.Split(inFirst, inLast);
+  return "(" + ChainOrder(inPlan, inFirst, aSplit) + " " + ChainOrder(inPlan, aSplit + 1, inLast) + ")";
+}
+
+inline std::string ChainOrder(const ChainPlan& inPlan) {
+  return ChainOrder(inPlan, 0, inPlan.Length() - 1);
+}
+
+// Buffers for the intermediates of MultiplyChain. Acquire hands out the smallest free buffer that is big
+// enough, failing that grows the largest free one, and allocates only when none is free.
+typedef struct ChainArena {
+  int* Acquire(const std::size_t inEntries) {
+    std::size_t aPick = fFree.size();
+    for (std::size_t n = 0; n < fFree.size(); ++n) {
+      const std::size_t aEntries = fBuffers[fFree[n]].size();
+      if (aPick == fFree.size()) {
+        aPick = n;
+        continue;
+      }
+      const std::size_t aPicked = fBuffers[fFree[aPick]].size();
+      const bool aFits = aEntries >= inEntries;
+      const bool aPickedFits = aPicked >= inEntries;
+      if ((aFits && (!aPickedFits || aEntries < aPicked)) || (!aFits && !aPickedFits && aEntries > aPicked)) {
+        aPick = n;
+      }
+    }
+    if (aPick == fFree.size()) {
+      fBuffers.emplace_back(inEntries);
+      ++fAllocations;
+      return fBuffers.back().data();
+    }
+    std::vector<int>& aBuffer = fBuffers[fFree[aPick]];
+    fFree.erase(fFree.begin() + aPick);
+    if (aBuffer.size() < inEntries) {
+      aBuffer.resize(inEntries);
+      ++fAllocations;
+    }
+    return aBuffer.data();
+  }
+
+  void Release(const int* inBuffer) {
+    for (std::size_t n = 0; n < fBuffers.size(); ++n) {
+      if (fBuffers[n].data() == inBuffer) {
+        fFree.push_back(n);
+        return;
+      }
+    }
+  }
+
+  std::size_t Bytes() const {
+    std::size_t aBytes = 0;
+    for (const std::vector<int>& aBuffer : fBuffers) {
+      aBytes += aBuffer.size() * sizeof(int);
+    }
+    return aBytes;
+  }
+
+  std::vector<std::vector<int>> fBuffers; // moving a vector keeps its data, so handed-out pointers stay valid
+  std::vector<std::size_t> fFree;         // indices into fBuffers
+  std::size_t fAllocations = 0;           // buffers allocated or grown
+} ChainArena;
+
+typedef struct ChainTaskData {
+  const ChainMatrix fMatrixA;
+  const ChainMatrix fMatrixB;
+  const ChainMatrix fMatrixC;
+  const uint16_t fStart;
+  const uint16_t fEnd;
+} ChainTaskData;
+
+// Rows [fStart, fEnd) of C = A B, each zeroed and then summed in place
+inline void* MultiplyChainRows(void* args) {
+  ChainTaskData* aTask = static_cast<ChainTaskData*>(args);
+  const ChainMatrix& A = aTask->fMatrixA;
+  const ChainMatrix& B = aTask->fMatrixB;
+  const ChainMatrix& C = aTask->fMatrixC;
+  for (uint16_t i = aTask->fStart; i < aTask->fEnd; ++i) {
+    const int* aRowA = A.Row(i);
+    int* aRowC = C.Row(i);
+    std::fill(aRowC, aRowC + C.columns, 0);
+    for (uint16_t k = 0; k < A.columns; ++k) {
+      const int aValue = aRowA[k];
+      const int* aRowB = B.Row(k);
+      for (uint16_t j = 0; j < C.columns; ++j) {
+        aRowC[j] += aValue * aRowB[j];
+      }
+    }
+  }
+  return NULL;
+}
+
+// A subchain of the plan's tree: a link of the chain (no operands) or the product of two other nodes
+typedef struct ChainNode {
+  int16_t fLeft;
+  int16_t fRight;
+  uint16_t fHeight;
+  ChainMatrix fMatrix;
+} ChainNode;
+
+inline int16_t AddChainNodes(const ChainPlan& inPlan, const std::vector<ChainMatrix>& inChain, const uint16_t inFirst,
+                             const uint16_t inLast, std::vector<ChainNode>& outNodes) {
+  if (inFirst == inLast) {
+    outNodes.push_back({-1, -1, 0, inChain[inFirst]});
+  } else {
+    const uint16_t aSplit = inPlan.Split(inFirst, inLast);
+    const int16_t aLeft = AddChainNodes(inPlan, inChain, inFirst, aSplit, outNodes);
+    const int16_t aRight = AddChainNodes(inPlan, inChain, aSplit + 1, inLast, outNodes);
+    const uint16_t aHeight = std::max(outNodes[aLeft].fHeight, outNodes[aRight].fHeight) + 1;
+    outNodes.push_back({aLeft, aRight, aHeight,
+                        {inPlan.fDimensions[inFirst], inPlan.fDimensions[inLast + 1], NULL}});
+  }
+  return outNodes.size() - 1;
+}
+
+// C = inChain[0] inChain[1] ... in the plan's order, C of the first link's rows and the last link's columns.
+// Nothing is read from C, and it must not be one of the links.
+inline void MultiplyChain(const std::vector<ChainMatrix>& inChain, const ChainPlan& inPlan, const ChainMatrix& C,
+                          ChainArena& ioArena, const uint16_t inMaxThreads = 0) {
+  if (inChain.size() == 1) {
+    std::copy(inChain[0].data, inChain[0].data + C.Entries(), C.data);
+    return;
+  }
+
+  std::vector<ChainNode> aNodes;
+  const int16_t aRoot = AddChainNodes(inPlan, inChain, 0, inChain.size() - 1, aNodes);
+  aNodes[aRoot].fMatrix.data = C.data;
+  const uint16_t maxThreads = PoolThreads(inMaxThreads);
+
+  for (uint16_t aHeight = 1; aHeight <= aNodes[aRoot].fHeight; ++aHeight) {
+    {
+      TaskQueue<ChainTaskData> aTaskQueue;
+      for (ChainNode& aNode : aNodes) {
+        if (aNode.fHeight != aHeight)
+          continue;
+        if (!aNode.fMatrix.data) {
+          aNode.fMatrix.data = ioArena.Acquire(aNode.fMatrix.Entries());
+        }
+        const uint16_t aRows = aNode.fMatrix.rows;
+        const uint16_t aGranularity = std::max(aRows / maxThreads, 1);
+        for (uint16_t aBlockStart = 0; aBlockStart < aRows; aBlockStart += aGranularity) {
+          const uint16_t aBlockEnd = std::min<uint32_t>(aBlockStart + aGranularity, aRows);
+          aTaskQueue.SetTask({&MultiplyChainRows, {aNodes[aNode.fLeft].fMatrix, aNodes[aNode.fRight].fMatrix,
+                                                   aNode.fMatrix, aBlockStart, aBlockEnd}});
+        }
+      }
+      ThreadPool<ChainTaskData> aThreadPool(maxThreads, aTaskQueue);
+      aThreadPool.Run();
+    }
+
+    // This height's operands are read for the last time: intermediates go back to the arena
+    for (const ChainNode& aNode : aNodes) {
+      if (aNode.fHeight != aHeight)
+        continue;
+      for (const int16_t aOperand : {aNode.fLeft, aNode.fRight}) {
+        if (aNodes[aOperand].fLeft >= 0) {
+          ioArena.Release(aNodes[aOperand].fMatrix.data);
+        }
+      }
+    }
+  }
+}
+
+// As above, in the FLOP-optimal order
+inline void MultiplyChain(const std::vector<ChainMatrix>& inChain, const ChainMatrix& C, ChainArena& ioArena,
+                          const uint16_t inMaxThreads = 0) {
+  std::vector<uint16_t> aDimensions{inChain[0].rows};
+  for (const ChainMatrix& aLink : inChain) {
+    aDimensions.push_back(aLink.columns);
+  }
+  MultiplyChain(inChain, PlanChain(aDimensions), C, ioArena, inMaxThreads);
+}
+
+#endif // MATRIX_CHAIN_H
@@ -0,0 +1,81 @@
+#ifndef MATRIX_MULTIPLY_H
+#define MATRIX_MULTIPLY_H
+
+#include <cstdint>
+
+#include <unistd.h>
+
+#include "matrix.h"
+#include "thread_pool.h"
+
+// The dense multiply of pthreads_MatrixMultiplication.cpp: C += A * B, blocks of rows of C queued as tasks
+// on a pool of one thread per core
+
+typedef struct TaskData {
+  TaskData(const Matrix& inA, const Matrix& inB, Matrix& inC, const uint16_t inStart, const uint16_t inEnd) :
+    fMatrixA(inA),
+    fMatrixB(inB),
+    fMatrixC(inC),
+    fStart(inStart),
+    fEnd(inEnd) {}
+  ~TaskData() = default;
+  const Matrix& fMatrixA;
+  const Matrix& fMatrixB;
+  Matrix& fMatrixC;
+  const uint16_t fStart;
+  const uint16_t fEnd;
+} TaskData;
+
+inline uint16_t PoolThreads(const uint16_t inMaxThreads) {
+  return (inMaxThreads > 0 ? inMaxThreads : sysconf(_SC_NPROCESSORS_ONLN));
+}
+
+inline void* MultiplyRow(void* args) {
+  TaskData* aTask = static_cast<TaskData*>(args);
+  const Matrix& A = aTask->fMatrixA;
+  const Matrix& B = aTask->fMatrixB;
+  Matrix& C = aTask->fMatrixC;
+  for (uint16_t i = aTask->fStart; i < aTask->fEnd; ++i) {
+    for (uint16_t j = 0; j < A.size; ++j) {
+      for (uint16_t k = 0; k < A.size; ++k) {
+        C.data[i][j] += A.data[i][k] * B.data[k][j];
+      }
+    }
+  }
+  return NULL;
+}
+
+// Queues inMakeTask(start, end) for blocks of [0, inCount) on a pool of inMaxThreads (0: one per core) and
+// runs them to completion
+template <typename Data, typename MakeTask>
+void RunBlocks(TaskFn inFunction, const uint32_t inCount, const uint16_t inMaxThreads, const MakeTask& inMakeTask) {
+  if (!inCount)
+    return;
+
+  TaskQueue<Data> aTaskQueue;
+  const uint16_t maxThreads = PoolThreads(inMaxThreads);
+
+  uint32_t aGranularity = 1;
+  if (inCount > maxThreads) {
+    aGranularity = inCount / maxThreads;
+  }
+
+  for (uint32_t aBlockStart = 0; aBlockStart < inCount; aBlockStart += aGranularity) {
+    uint32_t aBlockEnd = aBlockStart + aGranularity;
+    if (aBlockEnd > inCount) {
+      aBlockEnd = inCount;
+    }
+    aTaskQueue.SetTask({inFunction, inMakeTask(aBlockStart, aBlockEnd)});
+  }
+
+  ThreadPool<Data> aThreadPool(maxThreads, aTaskQueue);
+  aThreadPool.Run();
+}
+
+inline void MultiplyMatrices(const Matrix& A, const Matrix& B, Matrix& C, const uint16_t matrixSize, const uint16_t inMaxThreads = 0) {
+  RunBlocks<TaskData>(&MultiplyRow, matrixSize, inMaxThreads, [&](const uint16_t inStart, const uint16_t inEnd) {
+    return TaskData(A, B, C, inStart, inEnd);
+  });
+}
+
+#endif // MATRIX_MULTIPLY_H
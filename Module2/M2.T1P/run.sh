@@ -12,4 +12,39 @@ for SIZE in "${DATA_SIZES[@]}"; do
     # ./pthread_multiplication.o | awk '{print $3}' >> "pthread_${SIZE}.log"
     ./sequential_multiplication.o | awk '{print $3}' >> "sequential_${SIZE}.log" 
   done
-done
\ No newline at end of file
+done
+DENSITIES=(0.001 0.01 0.05 0.1 0.5)
+
+for DENSITY in "${DENSITIES[@]}"; do
+  for i in {1..10}; do
+    ./sparse_multiplication.o 1000 ${DENSITY} | grep duration >> "sparse_${DENSITY}.log"
+  done
+done
+
+BATCHES=("8 20000" "16 10000" "32 2000" "64 500" "128 60")
+
+for BATCH in "${BATCHES[@]}"; do
+  for i in {1..10}; do
+    ./batched_multiplication.o ${BATCH} | grep duration >> "batched_${BATCH// /_}.log"
+  done
+done
+
+for SIZE in 100 500 1000 2000; do
+  for i in {1..10}; do
+    ./gemm_multiplication.o ${SIZE} | grep duration >> "gemm_${SIZE}.log"
+  done
+done
+
+for SIZE in 100 500 1000 2000; do
+  for i in {1..10}; do
+    ./fixed_multiplication.o ${SIZE} | grep duration >> "fixed_${SIZE}.log"
+  done
+done
+
+CHAINS=("400 20 600 30 500 10 700 40 300" "10 1000 10 1000 10 1000" "200 300 100 400 50 600 20 500 80 700 30 300 90 200 10 600 40 100 300 50 250")
+
+for CHAIN in "${CHAINS[@]}"; do
+  for i in {1..10}; do
+    ./chain_multiplication.o ${CHAIN} | grep -e duration -e saved >> "chain_${CHAIN%% *}_$(echo ${CHAIN} | wc -w).log"
+  done
+done
@@ -0,0 +1,92 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "sparse_matrix.h"
+
+// Multiplies a sparse A (each entry non-zero with probability density) by a dense B with the dense pool
+// kernel, the CSR and CSC kernels and the automatic choice, checks they agree, and times SpMV against the
+// dense matrix-vector product.
+//
+// Usage: sparse_multiplication.o [matrixSize] [density]
+
+static long Microseconds(const std::chrono::high_resolution_clock::time_point inStart) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - inStart)
+    .count();
+}
+
+int main(int argc, char** argv) {
+  const uint16_t matrixSize = (argc > 1 ? atoi(argv[1]) : 1000);
+  const double density = (argc > 2 ? atof(argv[2]) : 0.05);
+  Matrix A(matrixSize);
+  Matrix B(matrixSize);
+  Matrix denseC(matrixSize);
+  Matrix sparseC(matrixSize);
+  Matrix transposedC(matrixSize);
+  Matrix autoC(matrixSize);
+  GenerateSparseMatrixData(A, density);
+  GenerateMatrixData(B);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  MultiplyMatrices(A, B, denseC, matrixSize);
+  std::printf("dense duration = %ld microseconds\n", Microseconds(start));
+
+  start = std::chrono::high_resolution_clock::now();
+  const CsrMatrix sparseA(A);
+  std::printf("csr duration = %ld microseconds (conversion)\n", Microseconds(start));
+  start = std::chrono::high_resolution_clock::now();
+  MultiplySparseMatrices(sparseA, B, sparseC);
+  std::printf("spmm duration = %ld microseconds\n", Microseconds(start));
+
+  // The same product transposed, (A B)^T = B^T A^T, exercises the dense x CSC kernel: B^T is dense, A^T is
+  // the CSC of A read as rows
+  Matrix transposedA(matrixSize);
+  Matrix transposedB(matrixSize);
+  for (uint16_t i = 0; i < matrixSize; ++i) {
+    for (uint16_t j = 0; j < matrixSize; ++j) {
+      transposedA.data[j][i] = A.data[i][j];
+      transposedB.data[j][i] = B.data[i][j];
+    }
+  }
+  start = std::chrono::high_resolution_clock::now();
+  MultiplySparseMatrices(transposedB, CscMatrix(transposedA), transposedC);
+  std::printf("dense x csc duration = %ld microseconds (with conversion)\n", Microseconds(start));
+
+  start = std::chrono::high_resolution_clock::now();
+  const MultiplyKernel kernel = MultiplyMatricesAuto(A, B, autoC);
+  static const char* const kKernelNames[] = {"dense", "sparse A", "sparse B"};
+  std::printf("auto duration = %ld microseconds (%s)\n", Microseconds(start), kKernelNames[kernel]);
+
+  std::vector<int> x(matrixSize);
+  for (uint16_t j = 0; j < matrixSize; ++j) {
+    x[j] = B.data[0][j];
+  }
+  std::vector<int> denseY(matrixSize, 0);
+  std::vector<int> sparseY(matrixSize, 0);
+  start = std::chrono::high_resolution_clock::now();
+  for (uint16_t i = 0; i < matrixSize; ++i) {
+    for (uint16_t j = 0; j < matrixSize; ++j) {
+      denseY[i] += A.data[i][j] * x[j];
+    }
+  }
+  std::printf("dense mv duration = %ld microseconds\n", Microseconds(start));
+  start = std::chrono::high_resolution_clock::now();
+  MultiplySparseVector(sparseA, x.data(), sparseY.data());
+  std::printf("spmv duration = %ld microseconds\n", Microseconds(start));
+
+  bool transposedMatches = true;
+  for (uint16_t i = 0; i < matrixSize && transposedMatches; ++i) {
+    for (uint16_t j = 0; j < matrixSize; ++j) {
+      transposedMatches &= (transposedC.data[j][i] == denseC.data[i][j]);
+    }
+  }
+  const bool matches = MatricesEqual(denseC, sparseC) && MatricesEqual(denseC, autoC) && transposedMatches &&
+                       denseY == sparseY;
+  std::printf("density = %.4f, nnz = %zu, dense bytes = %zu, csr bytes = %zu, results %s\n",
+              static_cast<double>(sparseA.NonZeros()) / matrixSize / matrixSize, sparseA.NonZeros(),
+              static_cast<std::size_t>(matrixSize) * matrixSize * sizeof(int), sparseA.Bytes(),
+              matches ? "match" : "DIFFER");
+  return matches ? 0 : 1;
+}
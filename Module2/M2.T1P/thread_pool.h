@@ -0,0 +1,110 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <optional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include <pthread.h>
+
+// https://stackoverflow.com/questions/7859754/can-i-keep-threads-alive-and-give-them-other-workloads
+
+// The task queue and thread pool of the pthreads multiply, shared by every kernel in this directory. A task
+// is a function and the data handed to it by value; Data is the kernel's own task struct. Queue the tasks,
+// then Run the pool: its threads drain the queue, and destroying the pool lets them finish what is queued
+// and joins them, so a kernel's results are complete once its pool goes out of scope. The threads sleep on
+// the queue's condition while it is empty rather than the pool spinning until it drains.
+
+typedef void*(*TaskFn)(void*);
+
+template <typename Data>
+struct TaskQueue {
+  typedef std::pair<TaskFn, Data> Task;
+
+  TaskQueue() {
+    pthread_cond_init(&fQueueConditional, NULL);
+    pthread_mutex_init(&fQueueMutex, NULL);
+  };
+
+  ~TaskQueue() {
+    pthread_cond_destroy(&fQueueConditional);
+    pthread_mutex_destroy(&fQueueMutex);
+  };
+
+  void SetTask(Task inTask) {
+    pthread_mutex_lock(&fQueueMutex);
+    fQueue.push(inTask);
+    pthread_mutex_unlock(&fQueueMutex);
+  }
+
+  std::optional<Task> GetTask() {
+    if (fQueue.size() > 0) {
+      Task aReturnTask = fQueue.front();
+      fQueue.pop();
+      return aReturnTask;
+    }
+    return std::nullopt;
+  }
+
+  // Under the mutex, so no thread can check fCompleted and then miss the broadcast
+  void FinaliseTasks() {
+    pthread_mutex_lock(&fQueueMutex);
+    fCompleted = true;
+    pthread_cond_broadcast(&fQueueConditional);
+    pthread_mutex_unlock(&fQueueMutex);
+  }
+
+  const inline std::size_t Size() {
+    return fQueue.size();
+  }
+  pthread_mutex_t fQueueMutex;
+  pthread_cond_t fQueueConditional;
+  std::atomic_bool fCompleted{false}; // no more tasks: the threads exit once the queue is empty
+  private:
+  std::queue<Task> fQueue;
+};
+
+template <typename Data>
+void* ThreadLoop(void* args) {
+  TaskQueue<Data>* aTaskQueue = static_cast<TaskQueue<Data>*>(args);
+  while (true) {
+    pthread_mutex_lock(&aTaskQueue->fQueueMutex);
+    while (!aTaskQueue->Size() && !aTaskQueue->fCompleted) {
+      pthread_cond_wait(&aTaskQueue->fQueueConditional, &aTaskQueue->fQueueMutex);
+    }
+    std::optional<typename TaskQueue<Data>::Task> aTask = aTaskQueue->GetTask();
+    pthread_mutex_unlock(&aTaskQueue->fQueueMutex);
+    if (!aTask.has_value())
+      break;
+    aTask->first(&aTask->second);
+  }
+  pthread_exit(NULL);
+}
+
+template <typename Data>
+struct ThreadPool {
+  ThreadPool(const unsigned int numThreads, TaskQueue<Data>& inTaskQueue) : fThreads(numThreads, 0), fTaskQueue(inTaskQueue) {
+  }
+  ~ThreadPool() {
+    fTaskQueue.FinaliseTasks();
+    for (std::size_t i = 0; i < fThreads.size(); ++i) {
+      pthread_join(fThreads[i], NULL);
+    }
+  }
+
+  void Run() {
+    InitPool();
+  }
+
+  void InitPool () {
+    for (std::size_t i = 0; i < fThreads.size(); ++i) {
+      pthread_create(&fThreads[i], NULL, &ThreadLoop<Data>, &fTaskQueue);
+    }
+  }
+  std::vector<pthread_t> fThreads;
+  TaskQueue<Data>& fTaskQueue;
+};
+
+#endif // THREAD_POOL_H
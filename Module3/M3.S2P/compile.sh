@@ -0,0 +1,3 @@
+#!/bin/bash
+
+mpicxx mpi_MatrixMultiplication.cpp --std=c++17 -O3 -o mpi_multiplication.o
@@ -0,0 +1,441 @@
+#include <mpi.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+// Usage: mpirun -np <tasks> ./mpi_multiplication.o [matrixSize] [--shared] [--verify]
+//                                                 [--checkpoint <dir>] [--block-rows <rows>] [--seed <seed>]
+//
+// --shared allocates A, B and C once per host with MPI_Win_allocate_shared. Ranks on the same host
+// map the same pages, so only the node leaders take part in the broadcast of the inputs and the
+// per-node footprint no longer grows with the number of ranks on the node.
+//
+// --checkpoint appends every finished block of C rows to <dir>/rank<R>.ckpt. Rerunning the same command
+// after a failure reloads the finished blocks and only multiplies the rest. Inputs are generated from a
+// fixed seed in this mode so the restarted job multiplies the same matrices.
+
+static constexpr int kRootRank = 0;
+static constexpr int kResultTag = 1;
+static constexpr uint32_t kCheckpointMagic = 0x4b504331; // "1CPK"
+static constexpr uint32_t kDefaultCheckpointSeed = 315;
+// Checkpoint writes are skipped while they would push I/O time above this fraction of compute time
+static constexpr double kCheckpointTargetOverhead = 0.02;
+
+typedef struct RowBlock {
+  uint32_t fStart;
+  uint32_t fEnd;
+  uint32_t Rows() const { return fEnd - fStart; }
+} RowBlock;
+
+typedef struct Options {
+  uint32_t fMatrixSize = 1000;
+  bool fShared = false;
+  bool fVerify = false;
+  std::string fCheckpointDir;
+  uint32_t fBlockRows = 16;
+  bool fSeeded = false;
+  uint32_t fSeed = kDefaultCheckpointSeed;
+} Options;
+
+typedef struct CheckpointHeader {
+  uint32_t fMagic;
+  uint32_t fMatrixSize;
+  uint32_t fNumTasks;
+  uint32_t fRank;
+  uint32_t fBlockRows;
+  uint32_t fSeed;
+} CheckpointHeader;
+
+typedef struct CheckpointStats {
+  double fComputeSeconds = 0.0;
+  double fCheckpointSeconds = 0.0; // writes the overhead target allowed
+  double fFlushSeconds = 0.0;      // the opening sync, and the final write when the target would have skipped it
+  uint32_t fBlocksRestored = 0;
+  uint32_t fBlocksWritten = 0;
+} CheckpointStats;
+
+Options ParseOptions(int argc, char** argv) {
+  Options aOptions;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--shared")) {
+      aOptions.fShared = true;
+    } else if (!std::strcmp(argv[i], "--verify")) {
+      aOptions.fVerify = true;
+    } else if (!std::strcmp(argv[i], "--checkpoint") && i + 1 < argc) {
+      aOptions.fCheckpointDir = argv[++i];
+      aOptions.fSeeded = true;
+    } else if (!std::strcmp(argv[i], "--block-rows") && i + 1 < argc) {
+      aOptions.fBlockRows = std::strtoul(argv[++i], NULL, 10);
+    } else if (!std::strcmp(argv[i], "--seed") && i + 1 < argc) {
+      aOptions.fSeed = std::strtoul(argv[++i], NULL, 10);
+      aOptions.fSeeded = true;
+    } else {
+      aOptions.fMatrixSize = std::strtoul(argv[i], NULL, 10);
+    }
+  }
+  if (!aOptions.fBlockRows) {
+    aOptions.fBlockRows = 1;
+  }
+  return aOptions;
+}
+
+// Contiguous block of rows owned by a rank. The first (size % numTasks) ranks take one extra row.
+RowBlock GetRowBlock(const int inRank, const int inNumTasks, const uint32_t inMatrixSize) {
+  const uint32_t aBaseRows = inMatrixSize / inNumTasks;
+  const uint32_t aExtraRows = inMatrixSize % inNumTasks;
+  const uint32_t aRank = static_cast<uint32_t>(inRank);
+  RowBlock aBlock;
+  aBlock.fStart = aRank * aBaseRows + (aRank < aExtraRows ? aRank : aExtraRows);
+  aBlock.fEnd = aBlock.fStart + aBaseRows + (aRank < aExtraRows ? 1 : 0);
+  return aBlock;
+}
+
+void GenerateMatrixData(int* outData, const uint32_t inMatrixSize, const Options& inOptions, const uint32_t inSeedOffset) {
+  std::random_device device;
+  std::mt19937 rng(inOptions.fSeeded ? inOptions.fSeed + inSeedOffset : device());
+  std::uniform_int_distribution<uint16_t> distribution(0, 100);
+  const uint64_t aElements = static_cast<uint64_t>(inMatrixSize) * inMatrixSize;
+  for (uint64_t i = 0; i < aElements; ++i) {
+    outData[i] = distribution(rng);
+  }
+}
+
+// C[rows] += A[rows] * B. A and C point at the first row of the block, B is the full matrix.
+void MultiplyRows(const int* A, const int* B, int* C, const uint32_t inMatrixSize, const uint32_t inRows) {
+  for (uint32_t i = 0; i < inRows; ++i) {
+    const int* aRowA = &A[static_cast<uint64_t>(i) * inMatrixSize];
+    int* aRowC = &C[static_cast<uint64_t>(i) * inMatrixSize];
+    // i-k-j ordering walks B and C row-wise instead of striding down the columns of B
+    for (uint32_t k = 0; k < inMatrixSize; ++k) {
+      const int aValueA = aRowA[k];
+      const int* aRowB = &B[static_cast<uint64_t>(k) * inMatrixSize];
+      for (uint32_t j = 0; j < inMatrixSize; ++j) {
+        aRowC[j] += aValueA * aRowB[j];
+      }
+    }
+  }
+}
+
+std::string CheckpointPath(const Options& inOptions, const int inRank) {
+  return inOptions.fCheckpointDir + "/rank" + std::to_string(inRank) + ".ckpt";
+}
+
+CheckpointHeader MakeCheckpointHeader(const Options& inOptions, const int inRank, const int inNumTasks) {
+  return {kCheckpointMagic, inOptions.fMatrixSize, static_cast<uint32_t>(inNumTasks),
+          static_cast<uint32_t>(inRank), inOptions.fBlockRows, inOptions.fSeed};
+}
+
+// Loads every complete record of a previous run into C and marks its block as done. A checkpoint written
+// for a different problem is discarded, and a record cut short by a crash is ignored. Returns the length
+// of the valid prefix of the file so the caller can drop the torn tail before appending.
+long RestoreCheckpoint(const Options& inOptions, const int inRank, const int inNumTasks, const RowBlock inBlock,
+                       int* C, std::vector<uint8_t>& outDone, CheckpointStats& outStats) {
+  FILE* aFile = std::fopen(CheckpointPath(inOptions, inRank).c_str(), "rb");
+  if (aFile == NULL)
+    return 0;
+
+  const CheckpointHeader aExpected = MakeCheckpointHeader(inOptions, inRank, inNumTasks);
+  CheckpointHeader aHeader;
+  if (std::fread(&aHeader, sizeof(aHeader), 1, aFile) != 1 || std::memcmp(&aHeader, &aExpected, sizeof(aHeader))) {
+    std::printf("Warning: rank %d ignoring checkpoint from a different run\n", inRank);
+    std::fclose(aFile);
+    return 0;
+  }
+
+  const uint32_t n = inOptions.fMatrixSize;
+  std::vector<int> aRows(static_cast<uint64_t>(inOptions.fBlockRows) * n);
+  long aValidLength = std::ftell(aFile);
+  uint32_t aBlockIndex = 0;
+  while (std::fread(&aBlockIndex, sizeof(aBlockIndex), 1, aFile) == 1 && aBlockIndex < outDone.size()) {
+    const uint32_t aStart = aBlockIndex * inOptions.fBlockRows;
+    const uint32_t aRowCount = std::min(inOptions.fBlockRows, inBlock.Rows() - aStart);
+    const std::size_t aCount = static_cast<std::size_t>(aRowCount) * n;
+    if (std::fread(aRows.data(), sizeof(int), aCount, aFile) != aCount)
+      break;
+    std::memcpy(&C[static_cast<uint64_t>(aStart) * n], aRows.data(), aCount * sizeof(int));
+    if (!outDone[aBlockIndex]) {
+      outDone[aBlockIndex] = 1;
+      outStats.fBlocksRestored++;
+    }
+    aValidLength = std::ftell(aFile);
+  }
+  std::fclose(aFile);
+  return aValidLength;
+}
+
+// Appends the pending blocks as (block index, rows) records and syncs them to disk.
+void WriteCheckpoint(FILE* inFile, const int* C, const uint32_t inMatrixSize, const RowBlock inBlock,
+                     const uint32_t inBlockRows, std::vector<uint32_t>& inPending) {
+  for (const uint32_t aBlockIndex : inPending) {
+    const uint32_t aStart = aBlockIndex * inBlockRows;
+    const uint32_t aRowCount = std::min(inBlockRows, inBlock.Rows() - aStart);
+    std::fwrite(&aBlockIndex, sizeof(aBlockIndex), 1, inFile);
+    std::fwrite(&C[static_cast<uint64_t>(aStart) * inMatrixSize], sizeof(int),
+                static_cast<std::size_t>(aRowCount) * inMatrixSize, inFile);
+  }
+  std::fflush(inFile);
+  fsync(fileno(inFile));
+  inPending.clear();
+}
+
+// Multiplies this rank's rows of C block by block. Without a checkpoint directory this is a single
+// MultiplyRows call. With one, finished blocks are restored first and the pending blocks are checkpointed
+// whenever the accumulated write time, plus the predicted cost of writing them, stays within
+// kCheckpointTargetOverhead of the compute time. The prediction is the dearest of the sync on opening the
+// file, the last write, and the last write's cost per block times the blocks now pending, so a write that
+// flushes a backlog is not priced as one block; it is still a prediction, and a slow fsync can overshoot it.
+// The final block is always written; when the target would have skipped it, that flush is timed apart with
+// the opening sync, as they are fixed costs per run rather than a share of compute. On a small job one fsync
+// can outweigh the whole multiply, so those alone can exceed the target.
+void ComputeRows(const int* A, const int* B, int* C, const RowBlock inBlock, const Options& inOptions,
+                 const int inRank, const int inNumTasks, CheckpointStats& outStats) {
+  const uint32_t n = inOptions.fMatrixSize;
+  if (inOptions.fCheckpointDir.empty()) {
+    MultiplyRows(A, B, C, n, inBlock.Rows());
+    return;
+  }
+
+  const uint32_t aBlockRows = inOptions.fBlockRows;
+  const uint32_t aNumBlocks = (inBlock.Rows() + aBlockRows - 1) / aBlockRows;
+  std::vector<uint8_t> aDone(aNumBlocks, 0);
+  const long aValidLength = RestoreCheckpoint(inOptions, inRank, inNumTasks, inBlock, C, aDone, outStats);
+
+  const std::string aPath = CheckpointPath(inOptions, inRank);
+  if (aValidLength > 0 && truncate(aPath.c_str(), aValidLength)) {
+    std::perror("Couldn't truncate the checkpoint file");
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+  FILE* aFile = std::fopen(aPath.c_str(), aValidLength > 0 ? "ab" : "wb");
+  if (aFile == NULL) {
+    std::perror("Couldn't open the checkpoint file");
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+  if (aValidLength == 0) {
+    const CheckpointHeader aHeader = MakeCheckpointHeader(inOptions, inRank, inNumTasks);
+    std::fwrite(&aHeader, sizeof(aHeader), 1, aFile);
+  }
+  // Syncing the header (or nothing, on a restart) costs what any write's fsync does, so it is the floor of
+  // every predicted write, the first included
+  auto aSyncStart = std::chrono::steady_clock::now();
+  std::fflush(aFile);
+  fsync(fileno(aFile));
+  const double aSyncSeconds =
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - aSyncStart).count();
+  outStats.fFlushSeconds += aSyncSeconds;
+  double aLastWriteSeconds = aSyncSeconds;
+  std::size_t aLastWriteBlocks = 1;
+
+  std::vector<uint32_t> aPending;
+  for (uint32_t aBlockIndex = 0; aBlockIndex < aNumBlocks; ++aBlockIndex) {
+    if (aDone[aBlockIndex])
+      continue;
+    const uint64_t aOffset = static_cast<uint64_t>(aBlockIndex) * aBlockRows * n;
+    const uint32_t aRowCount = std::min(aBlockRows, inBlock.Rows() - aBlockIndex * aBlockRows);
+
+    auto aComputeStart = std::chrono::steady_clock::now();
+    MultiplyRows(&A[aOffset], B, &C[aOffset], n, aRowCount);
+    auto aComputeStop = std::chrono::steady_clock::now();
+    outStats.fComputeSeconds += std::chrono::duration<double>(aComputeStop - aComputeStart).count();
+    aPending.push_back(aBlockIndex);
+    outStats.fBlocksWritten++;
+
+    const bool aLastBlock = (aBlockIndex + 1 == aNumBlocks);
+    const double aPredictedSeconds = std::max({aSyncSeconds, aLastWriteSeconds,
+                                               aLastWriteSeconds / aLastWriteBlocks * aPending.size()});
+    const double aProjectedSeconds = outStats.fCheckpointSeconds + aPredictedSeconds;
+    const bool aWithinTarget = (aProjectedSeconds <= kCheckpointTargetOverhead * outStats.fComputeSeconds);
+    if (aLastBlock || aWithinTarget) {
+      aLastWriteBlocks = aPending.size();
+      auto aWriteStart = std::chrono::steady_clock::now();
+      WriteCheckpoint(aFile, C, n, inBlock, aBlockRows, aPending);
+      auto aWriteStop = std::chrono::steady_clock::now();
+      aLastWriteSeconds = std::chrono::duration<double>(aWriteStop - aWriteStart).count();
+      (aWithinTarget ? outStats.fCheckpointSeconds : outStats.fFlushSeconds) += aLastWriteSeconds;
+    }
+  }
+  std::fclose(aFile);
+}
+
+bool VerifyResult(const int* A, const int* B, const int* C, const uint32_t inMatrixSize) {
+  std::vector<int> aExpected(static_cast<uint64_t>(inMatrixSize) * inMatrixSize, 0);
+  MultiplyRows(A, B, aExpected.data(), inMatrixSize, inMatrixSize);
+  return !std::memcmp(aExpected.data(), C, aExpected.size() * sizeof(int));
+}
+
+// Every rank receives its own copy of B plus its rows of A, then sends its rows of C back to the root.
+// Returns the number of matrix bytes held by this rank.
+uint64_t RunCopyMode(const Options& inOptions, const int inRank, const int inNumTasks, bool& outVerified,
+                     CheckpointStats& outStats) {
+  const uint32_t n = inOptions.fMatrixSize;
+  const uint64_t aElements = static_cast<uint64_t>(n) * n;
+  const RowBlock aBlock = GetRowBlock(inRank, inNumTasks, n);
+
+  std::vector<int> A;
+  std::vector<int> C;
+  std::vector<int> B(aElements);
+  std::vector<int> aLocalA(static_cast<uint64_t>(aBlock.Rows()) * n);
+  std::vector<int> aLocalC(static_cast<uint64_t>(aBlock.Rows()) * n, 0);
+  if (inRank == kRootRank) {
+    A.resize(aElements);
+    C.resize(aElements);
+    GenerateMatrixData(A.data(), n, inOptions, 0);
+    GenerateMatrixData(B.data(), n, inOptions, 1);
+  }
+
+  std::vector<int> aCounts(inNumTasks);
+  std::vector<int> aDisplacements(inNumTasks);
+  for (int aTask = 0; aTask < inNumTasks; ++aTask) {
+    const RowBlock aTaskBlock = GetRowBlock(aTask, inNumTasks, n);
+    aCounts[aTask] = aTaskBlock.Rows() * n;
+    aDisplacements[aTask] = aTaskBlock.fStart * n;
+  }
+
+  MPI_Bcast(B.data(), aElements, MPI_INT, kRootRank, MPI_COMM_WORLD);
+  MPI_Scatterv(A.data(), aCounts.data(), aDisplacements.data(), MPI_INT,
+               aLocalA.data(), aLocalA.size(), MPI_INT, kRootRank, MPI_COMM_WORLD);
+  ComputeRows(aLocalA.data(), B.data(), aLocalC.data(), aBlock, inOptions, inRank, inNumTasks, outStats);
+  MPI_Gatherv(aLocalC.data(), aLocalC.size(), MPI_INT,
+              C.data(), aCounts.data(), aDisplacements.data(), MPI_INT, kRootRank, MPI_COMM_WORLD);
+
+  if (inOptions.fVerify && inRank == kRootRank) {
+    outVerified = VerifyResult(A.data(), B.data(), C.data(), n);
+  }
+  return (B.size() + aLocalA.size() + aLocalC.size() + A.size() + C.size()) * sizeof(int);
+}
+
+// A, B and C live in one shared window per node. The node leader (node rank 0) owns the allocation,
+// the other ranks on the node map it through MPI_Win_shared_query. Only leaders exchange the inputs.
+uint64_t RunSharedMode(const Options& inOptions, const int inRank, const int inNumTasks, bool& outVerified,
+                       CheckpointStats& outStats) {
+  const uint32_t n = inOptions.fMatrixSize;
+  const uint64_t aElements = static_cast<uint64_t>(n) * n;
+  const RowBlock aBlock = GetRowBlock(inRank, inNumTasks, n);
+
+  MPI_Comm aNodeComm;
+  MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, inRank, MPI_INFO_NULL, &aNodeComm);
+  int aNodeRank = 0;
+  MPI_Comm_rank(aNodeComm, &aNodeRank);
+
+  // Keyed by world rank, so world rank 0 is both a node leader and rank 0 of the leader communicator
+  MPI_Comm aLeaderComm;
+  MPI_Comm_split(MPI_COMM_WORLD, aNodeRank == 0 ? 0 : MPI_UNDEFINED, inRank, &aLeaderComm);
+
+  const MPI_Aint aWindowBytes = (aNodeRank == 0 ? 3 * aElements * sizeof(int) : 0);
+  int* aBase = NULL;
+  MPI_Win aWindow;
+  MPI_Win_allocate_shared(aWindowBytes, sizeof(int), MPI_INFO_NULL, aNodeComm, &aBase, &aWindow);
+  if (aNodeRank != 0) {
+    MPI_Aint aQuerySize = 0;
+    int aDisplacementUnit = 0;
+    MPI_Win_shared_query(aWindow, 0, &aQuerySize, &aDisplacementUnit, &aBase);
+  }
+  int* A = aBase;
+  int* B = aBase + aElements;
+  int* C = aBase + 2 * aElements;
+
+  MPI_Win_fence(0, aWindow);
+  if (aNodeRank == 0) {
+    if (inRank == kRootRank) {
+      GenerateMatrixData(A, n, inOptions, 0);
+      GenerateMatrixData(B, n, inOptions, 1);
+    }
+    // A and B are adjacent in the window, so one broadcast moves both between nodes
+    MPI_Bcast(A, 2 * aElements, MPI_INT, kRootRank, aLeaderComm);
+    std::memset(C, 0, aElements * sizeof(int));
+  }
+  MPI_Win_fence(0, aWindow);
+
+  const uint64_t aRowOffset = static_cast<uint64_t>(aBlock.fStart) * n;
+  ComputeRows(&A[aRowOffset], B, &C[aRowOffset], aBlock, inOptions, inRank, inNumTasks, outStats);
+  MPI_Win_fence(0, aWindow);
+
+  // Rows computed on the root's node are already in the root's C. Remote nodes send theirs.
+  int aLeaderWorldRank = inRank;
+  MPI_Bcast(&aLeaderWorldRank, 1, MPI_INT, 0, aNodeComm);
+  const int aOnRootNode = (aLeaderWorldRank == kRootRank);
+  std::vector<int> aOnRootNodeFlags(inNumTasks);
+  MPI_Gather(&aOnRootNode, 1, MPI_INT, aOnRootNodeFlags.data(), 1, MPI_INT, kRootRank, MPI_COMM_WORLD);
+  if (inRank == kRootRank) {
+    for (int aTask = 0; aTask < inNumTasks; ++aTask) {
+      if (aOnRootNodeFlags[aTask])
+        continue;
+      const RowBlock aTaskBlock = GetRowBlock(aTask, inNumTasks, n);
+      MPI_Recv(&C[static_cast<uint64_t>(aTaskBlock.fStart) * n], aTaskBlock.Rows() * n, MPI_INT,
+               aTask, kResultTag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    }
+    if (inOptions.fVerify) {
+      outVerified = VerifyResult(A, B, C, n);
+    }
+  } else if (!aOnRootNode) {
+    MPI_Send(&C[aRowOffset], aBlock.Rows() * n, MPI_INT, kRootRank, kResultTag, MPI_COMM_WORLD);
+  }
+
+  MPI_Win_free(&aWindow);
+  if (aLeaderComm != MPI_COMM_NULL) {
+    MPI_Comm_free(&aLeaderComm);
+  }
+  MPI_Comm_free(&aNodeComm);
+  return aWindowBytes;
+}
+
+int main(int argc, char** argv) {
+  MPI_Init(&argc, &argv);
+  int aNumTasks = 0;
+  int aRank = 0;
+  MPI_Comm_size(MPI_COMM_WORLD, &aNumTasks);
+  MPI_Comm_rank(MPI_COMM_WORLD, &aRank);
+  const Options aOptions = ParseOptions(argc, argv);
+
+  bool aVerified = true;
+  CheckpointStats aStats;
+  MPI_Barrier(MPI_COMM_WORLD);
+  auto start = std::chrono::high_resolution_clock::now();
+  const uint64_t aRankBytes = (aOptions.fShared ? RunSharedMode(aOptions, aRank, aNumTasks, aVerified, aStats)
+                                                : RunCopyMode(aOptions, aRank, aNumTasks, aVerified, aStats));
+  auto stop = std::chrono::high_resolution_clock::now();
+  auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+
+  uint64_t aTotalBytes = 0;
+  MPI_Reduce(&aRankBytes, &aTotalBytes, 1, MPI_UINT64_T, MPI_SUM, kRootRank, MPI_COMM_WORLD);
+  double aRankTimes[3] = {aStats.fCheckpointSeconds, aStats.fComputeSeconds, aStats.fFlushSeconds};
+  double aTotalTimes[3] = {0.0, 0.0, 0.0};
+  MPI_Reduce(aRankTimes, aTotalTimes, 3, MPI_DOUBLE, MPI_SUM, kRootRank, MPI_COMM_WORLD);
+  uint32_t aRankBlocks[2] = {aStats.fBlocksRestored, aStats.fBlocksWritten};
+  uint32_t aTotalBlocks[2] = {0, 0};
+  MPI_Reduce(aRankBlocks, aTotalBlocks, 2, MPI_UINT32_T, MPI_SUM, kRootRank, MPI_COMM_WORLD);
+  if (aRank == kRootRank) {
+    std::printf("duration = %ld microseconds\n", duration.count());
+    std::printf("matrix memory = %lu bytes across %d ranks (%s)\n", aTotalBytes, aNumTasks,
+                aOptions.fShared ? "shared" : "copy");
+    if (!aOptions.fCheckpointDir.empty()) {
+      // Steady state is the writes the target governs; the opening sync and final flush are reported on their
+      // own and in the total
+      const double aOverhead = (aTotalTimes[1] > 0.0 ? 100.0 * aTotalTimes[0] / aTotalTimes[1] : 0.0);
+      const double aFlush = (aTotalTimes[1] > 0.0 ? 100.0 * aTotalTimes[2] / aTotalTimes[1] : 0.0);
+      std::printf("checkpoint overhead = %.2f%% steady state, %.2f%% opening and final flush, %.2f%% total "
+                  "(%u blocks restored, %u blocks computed)\n",
+                  aOverhead, aFlush, aOverhead + aFlush, aTotalBlocks[0], aTotalBlocks[1]);
+    }
+    if (aOptions.fVerify) {
+      std::printf("verify = %s\n", aVerified ? "passed" : "FAILED");
+    }
+  }
+
+  // The job finished, so a rerun must start from scratch rather than from these checkpoints
+  MPI_Barrier(MPI_COMM_WORLD);
+  if (!aOptions.fCheckpointDir.empty()) {
+    std::remove(CheckpointPath(aOptions, aRank).c_str());
+  }
+
+  MPI_Finalize();
+  return aVerified ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+#!/bin/bash
+
+NUM_TASKS=${NUM_TASKS:-16}
+DATA_SIZES=(500 1000 2000)
+CHECKPOINT_DIR=${CHECKPOINT_DIR:-./checkpoints}
+
+./compile.sh
+mkdir -p "${CHECKPOINT_DIR}"
+for SIZE in "${DATA_SIZES[@]}"; do
+  for i in {1..10}; do
+    mpirun -np ${NUM_TASKS} ./mpi_multiplication.o ${SIZE} | grep duration | awk '{print $3}' >> "mpi_copy_${SIZE}.log"
+    mpirun -np ${NUM_TASKS} ./mpi_multiplication.o ${SIZE} --shared | grep duration | awk '{print $3}' >> "mpi_shared_${SIZE}.log"
+    mpirun -np ${NUM_TASKS} ./mpi_multiplication.o ${SIZE} --checkpoint "${CHECKPOINT_DIR}" | grep overhead | awk '{print $4, $7, $12}' >> "mpi_checkpoint_overhead_${SIZE}.log"
+  done
+done
@@ -0,0 +1,93 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "opencl_autotuner.h"
+
+// Usage: ./autotune.o [vectorSize] [matrixSize] [--force]
+// Sweeps work-group sizes for every kernel in vector_ops.cl on the default device and records the fastest
+// in ./autotune.cache, which vector_ops.o and matrix_ops.o pick up on start-up.
+
+int main(int argc, char** argv) {
+  int aVectorSize = 1 << 22;
+  int aMatrixSize = 512;
+  bool aForce = false;
+  int aPositional = 0;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--force")) {
+      aForce = true;
+    } else if (aPositional++ == 0) {
+      aVectorSize = atoi(argv[i]);
+    } else {
+      aMatrixSize = atoi(argv[i]);
+    }
+  }
+
+  OpenCLEngine aEngine("./vector_ops.cl");
+  Autotuner aTuner(aEngine);
+  printf("Tuning for %s\n", GetDeviceString(aEngine.fDevice, CL_DEVICE_NAME).c_str());
+
+  // 0 leaves the work-group size to the runtime, which is sometimes the fastest choice
+  const std::vector<size_t> aVectorCandidates = {0, 16, 32, 64, 128, 256, 512, 1024};
+  const std::vector<size_t> aTileCandidates = {0, 4, 8, 16, 32};
+
+  std::vector<int> aA(aVectorSize, 3);
+  std::vector<int> aB(aVectorSize, 4);
+  std::vector<int> aC(aVectorSize);
+  const size_t aBytes = aVectorSize * sizeof(int);
+  cl_mem aBufferA = aEngine.AcquireBuffer(aBytes, CL_MEM_READ_ONLY);
+  cl_mem aBufferB = aEngine.AcquireBuffer(aBytes, CL_MEM_READ_ONLY);
+  cl_mem aBufferC = aEngine.AcquireBuffer(aBytes, CL_MEM_WRITE_ONLY);
+  // square_magnitude squares v in place, so it needs a buffer it can read, holding real data
+  cl_mem aBufferV = aEngine.AcquireBuffer(aBytes, CL_MEM_READ_WRITE);
+  CheckError(clEnqueueWriteBuffer(aEngine.fQueue, aBufferA, CL_TRUE, 0, aBytes, aA.data(), 0, NULL, NULL),
+             "Couldn't write the buffer");
+  CheckError(clEnqueueWriteBuffer(aEngine.fQueue, aBufferB, CL_TRUE, 0, aBytes, aB.data(), 0, NULL, NULL),
+             "Couldn't write the buffer");
+  CheckError(clEnqueueWriteBuffer(aEngine.fQueue, aBufferV, CL_TRUE, 0, aBytes, aA.data(), 0, NULL, NULL),
+             "Couldn't write the buffer");
+
+  // Kernels are timed on resident buffers so transfer time does not drown out the work-group effect
+  size_t aBest = aTuner.Tune("square_magnitude", aVectorCandidates, [&]() {
+    cl_kernel aKernel = aEngine.GetKernel("square_magnitude");
+    clSetKernelArg(aKernel, 0, sizeof(int), &aVectorSize);
+    clSetKernelArg(aKernel, 1, sizeof(cl_mem), &aBufferV);
+    aEngine.EnqueueKernel1D("square_magnitude", aVectorSize);
+    clFinish(aEngine.fQueue);
+  }, 3, aForce);
+  printf("square_magnitude -> %zu\n", aBest);
+  aEngine.ReleaseBuffer(aBufferV);
+
+  const int aWidths[] = {1, 4, 8};
+  const char* aAddKernels[] = {"vector_add", "vector_add_int4", "vector_add_int8"};
+  for (int i = 0; i < 3; ++i) {
+    const int aWidth = aWidths[i];
+    aBest = aTuner.Tune(aAddKernels[i], aVectorCandidates, [&]() {
+      aEngine.VectorAddOnBuffers(aBufferA, aBufferB, aBufferC, aVectorSize, aWidth);
+      clFinish(aEngine.fQueue);
+    }, 3, aForce);
+    printf("%s -> %zu\n", aAddKernels[i], aBest);
+  }
+  aEngine.ReleaseBuffer(aBufferA);
+  aEngine.ReleaseBuffer(aBufferB);
+  aEngine.ReleaseBuffer(aBufferC);
+
+  const size_t aMatrixBytes = static_cast<size_t>(aMatrixSize) * aMatrixSize * sizeof(int);
+  cl_mem aMatrixA = aEngine.AcquireBuffer(aMatrixBytes, CL_MEM_READ_ONLY);
+  cl_mem aMatrixB = aEngine.AcquireBuffer(aMatrixBytes, CL_MEM_READ_ONLY);
+  cl_mem aMatrixC = aEngine.AcquireBuffer(aMatrixBytes);
+  const int aZero = 0;
+  clEnqueueFillBuffer(aEngine.fQueue, aMatrixA, &aZero, sizeof(int), 0, aMatrixBytes, 0, NULL, NULL);
+  clEnqueueFillBuffer(aEngine.fQueue, aMatrixB, &aZero, sizeof(int), 0, aMatrixBytes, 0, NULL, NULL);
+  clEnqueueFillBuffer(aEngine.fQueue, aMatrixC, &aZero, sizeof(int), 0, aMatrixBytes, 0, NULL, NULL);
+  aBest = aTuner.Tune("matmul", aTileCandidates, [&]() {
+    aEngine.MultiplyMatricesOnBuffers(aMatrixA, aMatrixB, aMatrixC, aMatrixSize);
+    clFinish(aEngine.fQueue);
+  }, 3, aForce);
+  printf("matmul -> %zu x %zu tiles\n", aBest, aBest);
+  aEngine.ReleaseBuffer(aMatrixA);
+  aEngine.ReleaseBuffer(aMatrixB);
+  aEngine.ReleaseBuffer(aMatrixC);
+  return 0;
+}
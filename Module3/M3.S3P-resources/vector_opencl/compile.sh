@@ -0,0 +1,8 @@
+#!/bin/bash
+
+g++ vector_ops.cpp --std=c++17 -O3 -lOpenCL -o vector_ops.o
+g++ matrix_ops.cpp --std=c++17 -O3 -lOpenCL -o matrix_ops.o
+g++ autotune.cpp --std=c++17 -O3 -lOpenCL -o autotune.o
+g++ hetero_ops.cpp --std=c++17 -O3 -pthread -lOpenCL -o hetero_ops.o
+g++ pipeline_ops.cpp --std=c++17 -O3 -lOpenCL -o pipeline_ops.o
+g++ reduce_ops.cpp --std=c++17 -O3 -fopenmp -lOpenCL -o reduce_ops.o
@@ -0,0 +1,69 @@
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "hetero_scheduler.h"
+
+// Usage: ./hetero_ops.o [add|matmul] [size] [repeats]
+// Runs the job through HeteroScheduler several times so the split can adapt, and checks every result is
+// bit-identical to the same job run on a single worker (the first OpenCL device, or the host if none).
+
+void GenerateData(std::vector<int>& inData) {
+  std::random_device device;
+  std::mt19937 rng(device());
+  std::uniform_int_distribution<uint16_t> distribution(0, 100);
+  for (int& aValue : inData) {
+    aValue = distribution(rng);
+  }
+}
+
+int main(int argc, char** argv) {
+  const bool aMatmul = (argc > 1 && !strcmp(argv[1], "matmul"));
+  const int aSize = (argc > 2 ? atoi(argv[2]) : (aMatmul ? 1000 : 10000000));
+  const int aRepeats = (argc > 3 ? atoi(argv[3]) : 5);
+
+  const size_t aElements = (aMatmul ? static_cast<size_t>(aSize) * aSize : aSize);
+  std::vector<int> aA(aElements);
+  std::vector<int> aB(aElements);
+  GenerateData(aA);
+  GenerateData(aB);
+
+  HeteroScheduler aScheduler("./vector_ops.cl");
+
+  std::vector<int> aReference(aElements, 0);
+  HeteroWorker& aSingle = aScheduler.fWorkers.front();
+  if (aSingle.fEngine && aMatmul) {
+    aSingle.fEngine->MultiplyMatrices(aA.data(), aB.data(), aReference.data(), aSize);
+  } else if (aSingle.fEngine) {
+    aSingle.fEngine->VectorAdd(aA.data(), aB.data(), aReference.data(), aSize);
+  } else if (aMatmul) {
+    for (int i = 0; i < aSize; ++i)
+      for (int k = 0; k < aSize; ++k)
+        for (int j = 0; j < aSize; ++j)
+          aReference[static_cast<size_t>(i) * aSize + j] += aA[static_cast<size_t>(i) * aSize + k] * aB[static_cast<size_t>(k) * aSize + j];
+  } else {
+    for (int i = 0; i < aSize; ++i)
+      aReference[i] = aA[i] + aB[i];
+  }
+
+  bool aIdentical = true;
+  for (int aRun = 0; aRun < aRepeats; ++aRun) {
+    std::vector<int> aC(aElements, 0);
+    auto start = std::chrono::high_resolution_clock::now();
+    if (aMatmul) {
+      aScheduler.MultiplyMatrices(aA.data(), aB.data(), aC.data(), aSize);
+    } else {
+      aScheduler.VectorAdd(aA.data(), aB.data(), aC.data(), aSize);
+    }
+    auto stop = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+    const bool aMatches = !memcmp(aC.data(), aReference.data(), aElements * sizeof(int));
+    aIdentical = aIdentical && aMatches;
+
+    printf("run %d: duration = %ld microseconds, %s\n", aRun, duration.count(), aMatches ? "identical" : "MISMATCH");
+    aScheduler.PrintLastSplit();
+  }
+  return aIdentical ? 0 : 1;
+}
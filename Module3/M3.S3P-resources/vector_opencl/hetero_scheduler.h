@@ -0,0 +1,268 @@
+#ifndef HETERO_SCHEDULER_H
+#define HETERO_SCHEDULER_H
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "opencl_autotuner.h"
+
+// HeteroScheduler splits one vector or matrix job across every OpenCL device on every platform plus a
+// native std::thread worker on the host. Each worker gets a contiguous share of the elements (vector jobs)
+// or rows (matrix jobs) proportional to the throughput it achieved on the previous runs of the same job,
+// so the split converges to one where all workers finish together. Throughputs persist in a plain text
+// file, one "<job>\t<worker>\t<units per second>" line per entry.
+//
+// Every worker computes its share with the same integer arithmetic, so the combined output is
+// bit-identical to a single-device run regardless of the split.
+
+typedef struct HeteroWorker {
+  std::string fName;
+  std::unique_ptr<OpenCLEngine> fEngine; // NULL for the native worker
+  std::unique_ptr<Autotuner> fTuner;
+} HeteroWorker;
+
+typedef struct ThroughputEntry {
+  std::string fJob;
+  std::string fWorker;
+  double fUnitsPerSecond;
+} ThroughputEntry;
+
+typedef struct WorkerShare {
+  size_t fStart;
+  size_t fEnd;
+  double fSeconds;
+} WorkerShare;
+
+typedef struct HeteroScheduler {
+  // inNativeThreads: threads used by the host worker, 0 uses every core not driving an OpenCL device
+  HeteroScheduler(const char* inProgramFile, const char* inThroughputPath = "./hetero.throughput",
+                  unsigned int inNativeThreads = 0)
+    : fThroughputPath(inThroughputPath) {
+    cl_uint aNumPlatforms = 0;
+    clGetPlatformIDs(0, NULL, &aNumPlatforms);
+    std::vector<cl_platform_id> aPlatforms(aNumPlatforms);
+    if (aNumPlatforms) {
+      clGetPlatformIDs(aNumPlatforms, aPlatforms.data(), NULL);
+    }
+    for (const cl_platform_id aPlatform : aPlatforms) {
+      cl_uint aNumDevices = 0;
+      if (clGetDeviceIDs(aPlatform, CL_DEVICE_TYPE_ALL, 0, NULL, &aNumDevices) != CL_SUCCESS)
+        continue;
+      std::vector<cl_device_id> aDevices(aNumDevices);
+      clGetDeviceIDs(aPlatform, CL_DEVICE_TYPE_ALL, aNumDevices, aDevices.data(), NULL);
+      for (const cl_device_id aDevice : aDevices) {
+        HeteroWorker aWorker;
+        aWorker.fName = std::to_string(fWorkers.size()) + ":" + GetDeviceString(aDevice, CL_DEVICE_NAME);
+        aWorker.fEngine.reset(new OpenCLEngine(inProgramFile, ".", "", aDevice));
+        aWorker.fTuner.reset(new Autotuner(*aWorker.fEngine));
+        fWorkers.push_back(std::move(aWorker));
+      }
+    }
+
+    const unsigned int aCores = std::max(1u, std::thread::hardware_concurrency());
+    const unsigned int aDriverThreads = static_cast<unsigned int>(fWorkers.size());
+    fNativeThreads = (inNativeThreads ? inNativeThreads : (aCores > aDriverThreads ? aCores - aDriverThreads : 1));
+    HeteroWorker aNative;
+    aNative.fName = "native:" + std::to_string(fNativeThreads) + "-threads";
+    fWorkers.push_back(std::move(aNative));
+
+    LoadThroughput();
+  }
+
+  // c = a + b
+  void VectorAdd(const int* inA, const int* inB, int* outC, const int inSize) {
+    Run("vector_add", inSize, [&](HeteroWorker& inWorker, const size_t inStart, const size_t inEnd) {
+      const int aCount = static_cast<int>(inEnd - inStart);
+      if (inWorker.fEngine) {
+        inWorker.fEngine->VectorAdd(&inA[inStart], &inB[inStart], &outC[inStart], aCount);
+        return;
+      }
+      RunNative(inStart, inEnd, [&](const size_t inFrom, const size_t inTo) {
+        for (size_t i = inFrom; i < inTo; ++i) {
+          outC[i] = inA[i] + inB[i];
+        }
+      });
+    });
+  }
+
+  // C += A * B for square row-major matrices, split by rows
+  void MultiplyMatrices(const int* inA, const int* inB, int* inOutC, const int inSize) {
+    const size_t n = inSize;
+    Run("matmul", inSize, [&](HeteroWorker& inWorker, const size_t inStart, const size_t inEnd) {
+      if (inWorker.fEngine) {
+        inWorker.fEngine->MultiplyMatrixRows(&inA[inStart * n], inB, &inOutC[inStart * n], inSize,
+                                             static_cast<int>(inEnd - inStart));
+        return;
+      }
+      RunNative(inStart, inEnd, [&](const size_t inFrom, const size_t inTo) {
+        for (size_t i = inFrom; i < inTo; ++i) {
+          for (size_t k = 0; k < n; ++k) {
+            const int aValueA = inA[i * n + k];
+            for (size_t j = 0; j < n; ++j) {
+              inOutC[i * n + j] += aValueA * inB[k * n + j];
+            }
+          }
+        }
+      });
+    });
+  }
+
+  void PrintLastSplit() const {
+    for (std::size_t i = 0; i < fWorkers.size(); ++i) {
+      const WorkerShare& aShare = fLastSplit[i];
+      printf("%-40s units [%zu, %zu) in %.3f ms\n", fWorkers[i].fName.c_str(), aShare.fStart, aShare.fEnd,
+             aShare.fSeconds * 1000.0);
+    }
+  }
+
+  std::vector<HeteroWorker> fWorkers;
+
+  private:
+  typedef std::function<void(HeteroWorker&, const size_t, const size_t)> ShareFn;
+
+  // Partitions [0, inUnits) by the recorded throughputs, runs every non-empty share on its own thread,
+  // then folds the measured throughputs back in with an exponential moving average.
+  void Run(const std::string& inJob, const size_t inUnits, const ShareFn& inShareFn) {
+    std::vector<double> aThroughputs(fWorkers.size(), 0.0);
+    double aTotalThroughput = 0.0;
+    for (std::size_t i = 0; i < fWorkers.size(); ++i) {
+      // Unmeasured workers start from the mean of the measured ones (or 1 when none are measured)
+      aThroughputs[i] = GetThroughput(inJob, fWorkers[i].fName);
+      aTotalThroughput += aThroughputs[i];
+    }
+    std::size_t aMeasured = 0;
+    for (const double aThroughput : aThroughputs) {
+      aMeasured += (aThroughput > 0.0);
+    }
+    const double aDefault = (aMeasured ? aTotalThroughput / aMeasured : 1.0);
+    aTotalThroughput = 0.0;
+    for (double& aThroughput : aThroughputs) {
+      if (aThroughput <= 0.0) {
+        aThroughput = aDefault;
+      }
+      aTotalThroughput += aThroughput;
+    }
+
+    fLastSplit.assign(fWorkers.size(), {0, 0, 0.0});
+    double aCumulative = 0.0;
+    size_t aStart = 0;
+    for (std::size_t i = 0; i < fWorkers.size(); ++i) {
+      aCumulative += aThroughputs[i];
+      const size_t aEnd = (i + 1 == fWorkers.size() ? inUnits
+                                                     : static_cast<size_t>(inUnits * (aCumulative / aTotalThroughput)));
+      fLastSplit[i].fStart = aStart;
+      fLastSplit[i].fEnd = std::max(aStart, std::min(aEnd, inUnits));
+      aStart = fLastSplit[i].fEnd;
+    }
+
+    std::vector<std::thread> aThreads;
+    for (std::size_t i = 0; i < fWorkers.size(); ++i) {
+      WorkerShare& aShare = fLastSplit[i];
+      if (aShare.fStart == aShare.fEnd)
+        continue;
+      HeteroWorker& aWorker = fWorkers[i];
+      aThreads.emplace_back([&aWorker, &aShare, &inShareFn]() {
+        auto aBegin = std::chrono::steady_clock::now();
+        inShareFn(aWorker, aShare.fStart, aShare.fEnd);
+        auto aFinish = std::chrono::steady_clock::now();
+        aShare.fSeconds = std::chrono::duration<double>(aFinish - aBegin).count();
+      });
+    }
+    for (std::thread& aThread : aThreads) {
+      aThread.join();
+    }
+
+    for (std::size_t i = 0; i < fWorkers.size(); ++i) {
+      const WorkerShare& aShare = fLastSplit[i];
+      // Tiny shares are dominated by launch overhead and would skew the estimate
+      if (aShare.fSeconds <= 0.0 || (aShare.fEnd - aShare.fStart) * 100 < inUnits)
+        continue;
+      const double aMeasuredThroughput = (aShare.fEnd - aShare.fStart) / aShare.fSeconds;
+      const double aPrevious = GetThroughput(inJob, fWorkers[i].fName);
+      SetThroughput(inJob, fWorkers[i].fName,
+                    aPrevious > 0.0 ? kSmoothing * aMeasuredThroughput + (1.0 - kSmoothing) * aPrevious
+                                    : aMeasuredThroughput);
+    }
+    SaveThroughput();
+  }
+
+  // Splits [inStart, inEnd) evenly across fNativeThreads std::threads
+  void RunNative(const size_t inStart, const size_t inEnd, const std::function<void(size_t, size_t)>& inFn) {
+    const size_t aCount = inEnd - inStart;
+    const size_t aThreadCount = std::min<size_t>(fNativeThreads, aCount);
+    std::vector<std::thread> aThreads;
+    for (size_t t = 1; t < aThreadCount; ++t) {
+      aThreads.emplace_back(inFn, inStart + aCount * t / aThreadCount, inStart + aCount * (t + 1) / aThreadCount);
+    }
+    inFn(inStart, inStart + aCount / (aThreadCount ? aThreadCount : 1));
+    for (std::thread& aThread : aThreads) {
+      aThread.join();
+    }
+  }
+
+  double GetThroughput(const std::string& inJob, const std::string& inWorker) const {
+    for (const ThroughputEntry& aEntry : fThroughput) {
+      if (aEntry.fJob == inJob && aEntry.fWorker == inWorker)
+        return aEntry.fUnitsPerSecond;
+    }
+    return 0.0;
+  }
+
+  void SetThroughput(const std::string& inJob, const std::string& inWorker, const double inUnitsPerSecond) {
+    for (ThroughputEntry& aEntry : fThroughput) {
+      if (aEntry.fJob == inJob && aEntry.fWorker == inWorker) {
+        aEntry.fUnitsPerSecond = inUnitsPerSecond;
+        return;
+      }
+    }
+    fThroughput.push_back({inJob, inWorker, inUnitsPerSecond});
+  }
+
+  void LoadThroughput() {
+    std::string aContents;
+    if (!ReadFile(fThroughputPath, aContents))
+      return;
+    std::size_t aLineStart = 0;
+    while (aLineStart < aContents.size()) {
+      std::size_t aLineEnd = aContents.find('\n', aLineStart);
+      if (aLineEnd == std::string::npos) {
+        aLineEnd = aContents.size();
+      }
+      const std::string aLine = aContents.substr(aLineStart, aLineEnd - aLineStart);
+      aLineStart = aLineEnd + 1;
+      const std::size_t aFirstTab = aLine.find('\t');
+      const std::size_t aLastTab = aLine.rfind('\t');
+      if (aFirstTab == std::string::npos || aFirstTab == aLastTab)
+        continue;
+      fThroughput.push_back({aLine.substr(0, aFirstTab), aLine.substr(aFirstTab + 1, aLastTab - aFirstTab - 1),
+                             std::strtod(aLine.c_str() + aLastTab + 1, NULL)});
+    }
+  }
+
+  void SaveThroughput() const {
+    FILE* aHandle = fopen(fThroughputPath.c_str(), "w");
+    if (aHandle == NULL) {
+      perror("Couldn't write the throughput file");
+      return;
+    }
+    for (const ThroughputEntry& aEntry : fThroughput) {
+      fprintf(aHandle, "%s\t%s\t%.1f\n", aEntry.fJob.c_str(), aEntry.fWorker.c_str(), aEntry.fUnitsPerSecond);
+    }
+    fclose(aHandle);
+  }
+
+  // Weight of the newest measurement in the throughput moving average
+  static constexpr double kSmoothing = 0.5;
+
+  std::string fThroughputPath;
+  unsigned int fNativeThreads = 1;
+  std::vector<ThroughputEntry> fThroughput;
+  std::vector<WorkerShare> fLastSplit;
+} HeteroScheduler;
+
+#endif // HETERO_SCHEDULER_H
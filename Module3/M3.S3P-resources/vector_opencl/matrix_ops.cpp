@@ -0,0 +1,71 @@
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "opencl_autotuner.h"
+
+// Usage: ./matrix_ops.o [matrixSize] [--verify]
+// OpenCL counterpart of M2.T1P: C += A * B on square int matrices through the tiled matmul kernel, using the
+// tile size recorded in ./autotune.cache when autotune.o has been run for this device.
+
+void GenerateMatrixData(std::vector<int>& inMatrix) {
+  std::random_device device;
+  std::mt19937 rng(device());
+  std::uniform_int_distribution<uint16_t> distribution(0, 100);
+  for (int& aValue : inMatrix) {
+    aValue = distribution(rng);
+  }
+}
+
+void MultiplyMatricesSequential(const std::vector<int>& A, const std::vector<int>& B, std::vector<int>& C,
+                                const int matrixSize) {
+  for (int i = 0; i < matrixSize; ++i) {
+    for (int k = 0; k < matrixSize; ++k) {
+      for (int j = 0; j < matrixSize; ++j) {
+        C[i * matrixSize + j] += A[i * matrixSize + k] * B[k * matrixSize + j];
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  int matrixSize = 1000;
+  bool aVerify = false;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--verify")) {
+      aVerify = true;
+    } else {
+      matrixSize = atoi(argv[i]);
+    }
+  }
+
+  std::vector<int> A(static_cast<size_t>(matrixSize) * matrixSize);
+  std::vector<int> B(A.size());
+  std::vector<int> C(A.size(), 0);
+  GenerateMatrixData(A);
+  GenerateMatrixData(B);
+
+  OpenCLEngine aEngine("./vector_ops.cl");
+  Autotuner aTuner(aEngine);
+  aEngine.fProfiler.fEnabled = true;
+
+  auto start = std::chrono::high_resolution_clock::now();
+  aEngine.MultiplyMatrices(A.data(), B.data(), C.data(), matrixSize);
+  auto stop = std::chrono::high_resolution_clock::now();
+  auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+
+  printf("duration = %ld microseconds\n", duration.count());
+  printf("tile = %zu\n", aEngine.GetMatmulTile());
+  aEngine.fProfiler.Summary(stdout, "matrix_ops", GetDeviceString(aEngine.fDevice, CL_DEVICE_NAME).c_str(), "tiled",
+                            matrixSize, duration.count());
+  if (aVerify) {
+    std::vector<int> aExpected(A.size(), 0);
+    MultiplyMatricesSequential(A, B, aExpected, matrixSize);
+    const bool aPassed = (aExpected == C);
+    printf("verify = %s\n", aPassed ? "passed" : "FAILED");
+    return aPassed ? 0 : 1;
+  }
+  return 0;
+}
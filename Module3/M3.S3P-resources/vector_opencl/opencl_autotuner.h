@@ -0,0 +1,140 @@
+#ifndef OPENCL_AUTOTUNER_H
+#define OPENCL_AUTOTUNER_H
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "opencl_engine.h"
+
+// Autotuner sweeps work-group sizes for a kernel on the engine's device and keeps the fastest one.
+// Results are cached in a plain text file, one "<device>\t<driver>\t<kernel>\t<local size>" line per
+// entry, so a device is only tuned once. Constructing the tuner applies every cached entry for the
+// engine's device, which is all a program needs to do to run with tuned sizes.
+
+typedef struct TuningEntry {
+  std::string fDevice;
+  std::string fDriver;
+  std::string fKernel;
+  size_t fLocalSize;
+} TuningEntry;
+
+typedef struct Autotuner {
+  Autotuner(OpenCLEngine& inEngine, const char* inCachePath = "./autotune.cache")
+    : fEngine(inEngine),
+      fCachePath(inCachePath),
+      fDevice(GetDeviceString(inEngine.fDevice, CL_DEVICE_NAME)),
+      fDriver(GetDeviceString(inEngine.fDevice, CL_DRIVER_VERSION)) {
+    LoadCache();
+    for (const TuningEntry& aEntry : fEntries) {
+      if (aEntry.fDevice == fDevice && aEntry.fDriver == fDriver) {
+        fEngine.SetLocalSize(aEntry.fKernel, aEntry.fLocalSize);
+      }
+    }
+  }
+
+  // Times inRun for every candidate work-group size the kernel supports and keeps the fastest. inRun must
+  // launch the kernel through the engine and block until it completes. A cached result is reused unless
+  // inForce is set. Returns the chosen size.
+  size_t Tune(const char* inKernelName, const std::vector<size_t>& inCandidates, const std::function<void()>& inRun,
+              const int inRepeats = 3, const bool inForce = false) {
+    if (!inForce) {
+      for (const TuningEntry& aEntry : fEntries) {
+        if (aEntry.fDevice == fDevice && aEntry.fDriver == fDriver && aEntry.fKernel == inKernelName)
+          return aEntry.fLocalSize;
+      }
+    }
+
+    const size_t aMaxWorkGroup = fEngine.GetMaxWorkGroupSize(inKernelName);
+    const bool aIsMatmul = (std::string(inKernelName) == "matmul");
+    size_t aBestSize = 0;
+    double aBestSeconds = -1.0;
+    for (const size_t aCandidate : inCandidates) {
+      // matmul candidates are tile edges, so the work-group holds aCandidate^2 items
+      const size_t aWorkGroup = (aIsMatmul ? aCandidate * aCandidate : aCandidate);
+      if (aWorkGroup > aMaxWorkGroup)
+        continue;
+      fEngine.SetLocalSize(inKernelName, aCandidate);
+      inRun(); // Warm-up: first launch pays one-off costs such as buffer allocation
+      double aSeconds = -1.0;
+      for (int i = 0; i < inRepeats; ++i) {
+        auto aStart = std::chrono::steady_clock::now();
+        inRun();
+        auto aStop = std::chrono::steady_clock::now();
+        const double aElapsed = std::chrono::duration<double>(aStop - aStart).count();
+        if (aSeconds < 0.0 || aElapsed < aSeconds) {
+          aSeconds = aElapsed;
+        }
+      }
+      printf("%s local size %zu: %.3f ms\n", inKernelName, aCandidate, aSeconds * 1000.0);
+      if (aBestSeconds < 0.0 || aSeconds < aBestSeconds) {
+        aBestSeconds = aSeconds;
+        aBestSize = aCandidate;
+      }
+    }
+
+    fEngine.SetLocalSize(inKernelName, aBestSize);
+    Store(inKernelName, aBestSize);
+    return aBestSize;
+  }
+
+  private:
+  void LoadCache() {
+    std::string aContents;
+    if (!ReadFile(fCachePath, aContents))
+      return;
+    std::size_t aLineStart = 0;
+    while (aLineStart < aContents.size()) {
+      std::size_t aLineEnd = aContents.find('\n', aLineStart);
+      if (aLineEnd == std::string::npos) {
+        aLineEnd = aContents.size();
+      }
+      const std::string aLine = aContents.substr(aLineStart, aLineEnd - aLineStart);
+      aLineStart = aLineEnd + 1;
+
+      std::vector<std::string> aFields;
+      std::size_t aFieldStart = 0;
+      for (std::size_t aTab = aLine.find('\t'); aTab != std::string::npos; aTab = aLine.find('\t', aFieldStart)) {
+        aFields.push_back(aLine.substr(aFieldStart, aTab - aFieldStart));
+        aFieldStart = aTab + 1;
+      }
+      aFields.push_back(aLine.substr(aFieldStart));
+      if (aFields.size() == 4) {
+        fEntries.push_back({aFields[0], aFields[1], aFields[2], std::strtoull(aFields[3].c_str(), NULL, 10)});
+      }
+    }
+  }
+
+  void Store(const char* inKernelName, const size_t inLocalSize) {
+    bool aReplaced = false;
+    for (TuningEntry& aEntry : fEntries) {
+      if (aEntry.fDevice == fDevice && aEntry.fDriver == fDriver && aEntry.fKernel == inKernelName) {
+        aEntry.fLocalSize = inLocalSize;
+        aReplaced = true;
+      }
+    }
+    if (!aReplaced) {
+      fEntries.push_back({fDevice, fDriver, inKernelName, inLocalSize});
+    }
+
+    FILE* aHandle = fopen(fCachePath.c_str(), "w");
+    if (aHandle == NULL) {
+      perror("Couldn't write the autotune cache");
+      return;
+    }
+    for (const TuningEntry& aEntry : fEntries) {
+      fprintf(aHandle, "%s\t%s\t%s\t%zu\n", aEntry.fDevice.c_str(), aEntry.fDriver.c_str(), aEntry.fKernel.c_str(),
+              aEntry.fLocalSize);
+    }
+    fclose(aHandle);
+  }
+
+  OpenCLEngine& fEngine;
+  std::string fCachePath;
+  std::string fDevice;
+  std::string fDriver;
+  std::vector<TuningEntry> fEntries;
+} Autotuner;
+
+#endif // OPENCL_AUTOTUNER_H
@@ -0,0 +1,578 @@
+#ifndef OPENCL_ENGINE_H
+#define OPENCL_ENGINE_H
+
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 200
+#endif
+
+#include <CL/cl.h>
+
+#include "opencl_profiler.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+// OpenCLEngine owns a device, context, queue and compiled program for the lifetime of the process.
+// Compiled program binaries are cached on disk (keyed by the source, device and driver), kernels are
+// created once per name, and device buffers are recycled through a pool, so repeated kernel calls pay
+// neither the compile nor the allocation cost that vector_ops.cpp used to pay on every run.
+
+inline void CheckError(const cl_int inError, const char* inMessage) {
+  if (inError < 0) {
+    perror(inMessage);
+    printf("error = %d\n", inError);
+    exit(1);
+  }
+}
+
+// Returns the first GPU found on any platform, falling back to the first CPU device (e.g. PoCL)
+inline cl_device_id CreateDevice() {
+  cl_uint aNumPlatforms = 0;
+  CheckError(clGetPlatformIDs(0, NULL, &aNumPlatforms), "Couldn't identify a platform");
+  if (!aNumPlatforms) {
+    CheckError(CL_DEVICE_NOT_FOUND, "Couldn't identify a platform");
+  }
+  std::vector<cl_platform_id> aPlatforms(aNumPlatforms);
+  clGetPlatformIDs(aNumPlatforms, aPlatforms.data(), NULL);
+
+  const cl_device_type aPreferredTypes[] = {CL_DEVICE_TYPE_GPU, CL_DEVICE_TYPE_CPU};
+  for (const cl_device_type aType : aPreferredTypes) {
+    for (const cl_platform_id aPlatform : aPlatforms) {
+      cl_device_id aDevice;
+      if (clGetDeviceIDs(aPlatform, aType, 1, &aDevice, NULL) == CL_SUCCESS) {
+        return aDevice;
+      }
+    }
+    if (aType == CL_DEVICE_TYPE_GPU) {
+      printf("GPU not found\n");
+    }
+  }
+  CheckError(CL_DEVICE_NOT_FOUND, "Couldn't access any devices");
+  return NULL;
+}
+
+inline std::string GetDeviceString(const cl_device_id inDevice, const cl_device_info inInfo) {
+  size_t aSize = 0;
+  clGetDeviceInfo(inDevice, inInfo, 0, NULL, &aSize);
+  std::string aValue(aSize, '\0');
+  clGetDeviceInfo(inDevice, inInfo, aSize, &aValue[0], NULL);
+  if (!aValue.empty() && aValue.back() == '\0') {
+    aValue.pop_back();
+  }
+  return aValue;
+}
+
+// 64-bit FNV-1a, used to key the program binary cache
+inline uint64_t HashString(const std::string& inValue, uint64_t inHash = 14695981039346656037ull) {
+  for (const unsigned char aChar : inValue) {
+    inHash ^= aChar;
+    inHash *= 1099511628211ull;
+  }
+  return inHash;
+}
+
+inline bool ReadFile(const std::string& inPath, std::string& outContents) {
+  FILE* aHandle = fopen(inPath.c_str(), "rb");
+  if (aHandle == NULL)
+    return false;
+  fseek(aHandle, 0, SEEK_END);
+  const long aSize = ftell(aHandle);
+  rewind(aHandle);
+  outContents.resize(aSize > 0 ? aSize : 0);
+  const size_t aRead = fread(&outContents[0], 1, outContents.size(), aHandle);
+  fclose(aHandle);
+  return aRead == outContents.size();
+}
+
+typedef struct PooledBuffer {
+  cl_mem fBuffer;
+  size_t fBytes;
+  cl_mem_flags fFlags;
+} PooledBuffer;
+
+// Device buffer allocated with CL_MEM_ALLOC_HOST_PTR. The host fills and reads it through Map/Unmap,
+// which on CPU and integrated devices hands back the backing pages instead of copying them.
+typedef struct MappedVector {
+  MappedVector(cl_context inContext, cl_command_queue inQueue, const int inSize)
+    : fQueue(inQueue), fSize(inSize) {
+    cl_int aError = CL_SUCCESS;
+    fBuffer = clCreateBuffer(inContext, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, Bytes(), NULL, &aError);
+    CheckError(aError, "Couldn't create a host mapped buffer");
+  }
+
+  ~MappedVector() {
+    if (fHostPointer != NULL) {
+      Unmap();
+    }
+    clReleaseMemObject(fBuffer);
+  }
+
+  MappedVector(const MappedVector&) = delete;
+  MappedVector& operator=(const MappedVector&) = delete;
+
+  // CL_MAP_WRITE_INVALIDATE_REGION tells the runtime the old contents are not needed
+  int* Map(const cl_map_flags inFlags) {
+    cl_int aError = CL_SUCCESS;
+    fHostPointer = static_cast<int*>(clEnqueueMapBuffer(fQueue, fBuffer, CL_TRUE, inFlags, 0, Bytes(),
+                                                        0, NULL, NULL, &aError));
+    CheckError(aError, "Couldn't map the buffer");
+    return fHostPointer;
+  }
+
+  void Unmap() {
+    cl_event aEvent = NULL;
+    CheckError(clEnqueueUnmapMemObject(fQueue, fBuffer, fHostPointer, 0, NULL, &aEvent),
+               "Couldn't unmap the buffer");
+    clWaitForEvents(1, &aEvent);
+    clReleaseEvent(aEvent);
+    fHostPointer = NULL;
+  }
+
+  size_t Bytes() const { return fSize * sizeof(int); }
+
+  cl_command_queue fQueue;
+  cl_mem fBuffer;
+  int fSize;
+  int* fHostPointer = NULL;
+} MappedVector;
+
+static const cl_queue_properties kQueueProperties[] = {CL_QUEUE_PROPERTIES, CL_QUEUE_PROFILING_ENABLE, 0};
+
+typedef struct OpenCLEngine {
+  // inProgramFile: OpenCL C source (e.g. vector_ops.cl)
+  // inCacheDir: directory the compiled binaries are cached in
+  // inBuildOptions: passed to clBuildProgram, e.g. "-DMACRO=VALUE" or "-cl-opt-disable"
+  OpenCLEngine(const char* inProgramFile, const char* inCacheDir = ".", const char* inBuildOptions = "",
+               cl_device_id inDevice = NULL)
+    : fDevice(inDevice ? inDevice : CreateDevice()), fBuildOptions(inBuildOptions) {
+    cl_int aError = CL_SUCCESS;
+    // clCreateContext creates an OpenCL context using one or more devices found within a platform
+    fContext = clCreateContext(NULL, 1, &fDevice, NULL, NULL, &aError);
+    CheckError(aError, "Couldn't create a context");
+
+    // Operations in this queue are executed sequentially. Profiling is always enabled on the queue, but
+    // events are only requested while fProfiler.fEnabled is set.
+    fQueue = clCreateCommandQueueWithProperties(fContext, fDevice, kQueueProperties, &aError);
+    CheckError(aError, "Couldn't create a command queue");
+
+    fProgram = BuildProgram(inProgramFile, inCacheDir);
+  }
+
+  ~OpenCLEngine() {
+    clFinish(fQueue);
+    fProfiler.Drain();
+    for (cl_command_queue aQueue : fTransferQueues) {
+      if (aQueue != NULL) {
+        clFinish(aQueue);
+        clReleaseCommandQueue(aQueue);
+      }
+    }
+    for (const PooledBuffer& aBuffer : fBufferPool) {
+      clReleaseMemObject(aBuffer.fBuffer);
+    }
+    for (const auto& aKernel : fKernels) {
+      clReleaseKernel(aKernel.second);
+    }
+    clReleaseCommandQueue(fQueue);
+    clReleaseProgram(fProgram);
+    clReleaseContext(fContext);
+  }
+
+  OpenCLEngine(const OpenCLEngine&) = delete;
+  OpenCLEngine& operator=(const OpenCLEngine&) = delete;
+
+  // Kernels are created on first use and then reused; clSetKernelArg state is overwritten per call
+  cl_kernel GetKernel(const char* inKernelName) {
+    auto aFound = fKernels.find(inKernelName);
+    if (aFound != fKernels.end())
+      return aFound->second;
+    cl_int aError = CL_SUCCESS;
+    cl_kernel aKernel = clCreateKernel(fProgram, inKernelName, &aError);
+    CheckError(aError, "Couldn't create a kernel");
+    fKernels[inKernelName] = aKernel;
+    return aKernel;
+  }
+
+  // Hands out the smallest pooled buffer with matching flags that fits, or allocates a new one.
+  // Buffers go back into the pool through ReleaseBuffer and are only freed with the engine.
+  cl_mem AcquireBuffer(const size_t inBytes, const cl_mem_flags inFlags = CL_MEM_READ_WRITE) {
+    std::size_t aBest = fBufferPool.size();
+    for (std::size_t i = 0; i < fBufferPool.size(); ++i) {
+      const PooledBuffer& aBuffer = fBufferPool[i];
+      if (aBuffer.fFlags == inFlags && aBuffer.fBytes >= inBytes &&
+          (aBest == fBufferPool.size() || aBuffer.fBytes < fBufferPool[aBest].fBytes)) {
+        aBest = i;
+      }
+    }
+    if (aBest != fBufferPool.size()) {
+      const PooledBuffer aBuffer = fBufferPool[aBest];
+      fBufferPool.erase(fBufferPool.begin() + aBest);
+      fBuffersInUse.push_back(aBuffer);
+      return aBuffer.fBuffer;
+    }
+    cl_int aError = CL_SUCCESS;
+    cl_mem aBuffer = clCreateBuffer(fContext, inFlags, inBytes, NULL, &aError);
+    CheckError(aError, "Couldn't create a buffer");
+    fBuffersInUse.push_back({aBuffer, inBytes, inFlags});
+    return aBuffer;
+  }
+
+  void ReleaseBuffer(const cl_mem inBuffer) {
+    for (std::size_t i = 0; i < fBuffersInUse.size(); ++i) {
+      if (fBuffersInUse[i].fBuffer == inBuffer) {
+        fBufferPool.push_back(fBuffersInUse[i]);
+        fBuffersInUse.erase(fBuffersInUse.begin() + i);
+        return;
+      }
+    }
+  }
+
+  // Work-group size used for a kernel, 0 leaves the choice to the runtime. The autotuner
+  // (opencl_autotuner.h) fills these in per device; for matmul the value is the tile edge.
+  size_t GetLocalSize(const std::string& inKernelName) const {
+    auto aFound = fLocalSizes.find(inKernelName);
+    return aFound != fLocalSizes.end() ? aFound->second : 0;
+  }
+
+  void SetLocalSize(const std::string& inKernelName, const size_t inLocalSize) {
+    fLocalSizes[inKernelName] = inLocalSize;
+  }
+
+  size_t GetMaxWorkGroupSize(const char* inKernelName) {
+    size_t aMaxSize = 1;
+    clGetKernelWorkGroupInfo(GetKernel(inKernelName), fDevice, CL_KERNEL_WORK_GROUP_SIZE, sizeof(aMaxSize),
+                             &aMaxSize, NULL);
+    return aMaxSize;
+  }
+
+  // Enqueues a 1-D kernel over inWorkItems work-items on fQueue. With a tuned work-group size the global
+  // size is rounded up to a multiple of it; every kernel in vector_ops.cl bounds-checks its index.
+  void EnqueueKernel1D(const char* inKernelName, const size_t inWorkItems, const cl_uint inNumWaitEvents = 0,
+                       const cl_event* inWaitEvents = NULL, cl_event* outEvent = NULL) {
+    const size_t aLocalSize = GetLocalSize(inKernelName);
+    size_t aGlobal[1] = {inWorkItems};
+    size_t aLocal[1] = {aLocalSize};
+    if (aLocalSize) {
+      aGlobal[0] = ((inWorkItems + aLocalSize - 1) / aLocalSize) * aLocalSize;
+    }
+    cl_event* aEvent = (outEvent != NULL ? outEvent : fProfiler.Track(CommandKind::Kernel, inKernelName));
+    CheckError(clEnqueueNDRangeKernel(fQueue, GetKernel(inKernelName), 1, NULL, aGlobal, aLocalSize ? aLocal : NULL,
+                                      inNumWaitEvents, inWaitEvents, aEvent), "Couldn't enqueue the kernel");
+  }
+
+  // Runs a kernel with the signature (const int size, __global int* v) over v in place
+  void RunInPlace(const char* inKernelName, int* inOutVector, const int inSize) {
+    const size_t aBytes = inSize * sizeof(int);
+    cl_mem aBuffer = AcquireBuffer(aBytes);
+    CheckError(clEnqueueWriteBuffer(fQueue, aBuffer, CL_FALSE, 0, aBytes, inOutVector, 0, NULL,
+                                    fProfiler.Track(CommandKind::Upload, inKernelName, aBytes)),
+               "Couldn't write the buffer");
+
+    RunInPlaceOnBuffer(inKernelName, aBuffer, inSize);
+
+    // The queue is in-order, so the blocking read also waits for the kernel
+    CheckError(clEnqueueReadBuffer(fQueue, aBuffer, CL_TRUE, 0, aBytes, inOutVector, 0, NULL,
+                                   fProfiler.Track(CommandKind::Download, inKernelName, aBytes)),
+               "Couldn't read the buffer");
+    ReleaseBuffer(aBuffer);
+    fProfiler.Drain();
+  }
+
+  // Wraps the caller's memory with CL_MEM_USE_HOST_PTR instead of copying it into a device buffer.
+  // Mapping after the kernel is what makes the results visible on the host; on CPU devices with a
+  // page aligned pointer both the wrap and the map are free. The buffer is tied to inOutVector, so it
+  // bypasses the pool.
+  void RunInPlaceHostPointer(const char* inKernelName, int* inOutVector, const int inSize) {
+    const size_t aBytes = inSize * sizeof(int);
+    cl_int aError = CL_SUCCESS;
+    cl_mem aBuffer = clCreateBuffer(fContext, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, aBytes, inOutVector, &aError);
+    CheckError(aError, "Couldn't wrap the host pointer");
+    RunInPlaceOnBuffer(inKernelName, aBuffer, inSize);
+
+    void* aMapped = clEnqueueMapBuffer(fQueue, aBuffer, CL_TRUE, CL_MAP_READ, 0, aBytes, 0, NULL, NULL, &aError);
+    CheckError(aError, "Couldn't map the buffer");
+    cl_event aEvent = NULL;
+    clEnqueueUnmapMemObject(fQueue, aBuffer, aMapped, 0, NULL, &aEvent);
+    clWaitForEvents(1, &aEvent);
+    clReleaseEvent(aEvent);
+    clReleaseMemObject(aBuffer);
+    fProfiler.Drain();
+  }
+
+  // Runs the kernel over a MappedVector that the host has already filled and unmapped
+  void RunInPlaceMapped(const char* inKernelName, MappedVector& inOutVector) {
+    RunInPlaceOnBuffer(inKernelName, inOutVector.fBuffer, inOutVector.fSize);
+    clFinish(fQueue);
+    fProfiler.Drain();
+  }
+
+  // Splits the vector into inChunks pieces and pushes them through three in-order queues: upload,
+  // compute (fQueue) and download. Chunk k's kernel waits on its own upload and chunk k's download
+  // waits on its own kernel, so the upload of chunk k+1 overlaps the kernel of chunk k.
+  void RunInPlacePipelined(const char* inKernelName, int* inOutVector, const int inSize, const int inChunks) {
+    const int aChunks = (inChunks < 1 ? 1 : (inChunks > inSize ? inSize : inChunks));
+    const size_t aBytes = inSize * sizeof(int);
+    cl_mem aBuffer = AcquireBuffer(aBytes);
+    cl_command_queue aUploadQueue = GetTransferQueue(0);
+    cl_command_queue aDownloadQueue = GetTransferQueue(1);
+
+    cl_kernel aKernel = GetKernel(inKernelName);
+    clSetKernelArg(aKernel, 0, sizeof(int), &inSize);
+    clSetKernelArg(aKernel, 1, sizeof(cl_mem), &aBuffer);
+
+    std::vector<std::pair<cl_event, size_t>> aEvents;
+    aEvents.reserve(3 * aChunks);
+    for (int aChunk = 0; aChunk < aChunks; ++aChunk) {
+      const size_t aStart = static_cast<size_t>(inSize) * aChunk / aChunks;
+      const size_t aEnd = static_cast<size_t>(inSize) * (aChunk + 1) / aChunks;
+      const size_t aOffsetBytes = aStart * sizeof(int);
+      const size_t aChunkBytes = (aEnd - aStart) * sizeof(int);
+
+      cl_event aUploaded = NULL;
+      cl_event aComputed = NULL;
+      cl_event aDownloaded = NULL;
+      CheckError(clEnqueueWriteBuffer(aUploadQueue, aBuffer, CL_FALSE, aOffsetBytes, aChunkBytes,
+                                      &inOutVector[aStart], 0, NULL, &aUploaded), "Couldn't write the buffer");
+      // No work-group size here: rounding a chunk up would let it touch the next, still uploading, chunk
+      const size_t aOffset[1] = {aStart};
+      const size_t aGlobal[1] = {aEnd - aStart};
+      CheckError(clEnqueueNDRangeKernel(fQueue, aKernel, 1, aOffset, aGlobal, NULL, 1, &aUploaded, &aComputed),
+                 "Couldn't enqueue the kernel");
+      CheckError(clEnqueueReadBuffer(aDownloadQueue, aBuffer, CL_FALSE, aOffsetBytes, aChunkBytes,
+                                     &inOutVector[aStart], 1, &aComputed, &aDownloaded), "Couldn't read the buffer");
+      aEvents.push_back({aUploaded, aChunkBytes});
+      aEvents.push_back({aComputed, 0});
+      aEvents.push_back({aDownloaded, aChunkBytes});
+      // Start the transfer engines early rather than at the final wait
+      clFlush(aUploadQueue);
+      clFlush(fQueue);
+    }
+    clFlush(aDownloadQueue);
+    clFinish(aDownloadQueue);
+    // Events come in (upload, kernel, download) triples; the profiler releases them
+    for (std::size_t i = 0; i < aEvents.size(); ++i) {
+      const CommandKind aKind = (i % 3 == 0 ? CommandKind::Upload : (i % 3 == 1 ? CommandKind::Kernel : CommandKind::Download));
+      fProfiler.Adopt(aEvents[i].first, aKind, inKernelName, aEvents[i].second);
+    }
+    fProfiler.Drain();
+    ReleaseBuffer(aBuffer);
+  }
+
+  bool HasHostUnifiedMemory() const {
+    cl_bool aUnified = CL_FALSE;
+    clGetDeviceInfo(fDevice, CL_DEVICE_HOST_UNIFIED_MEMORY, sizeof(aUnified), &aUnified, NULL);
+    return aUnified == CL_TRUE;
+  }
+
+  void SquareMagnitude(int* inOutVector, const int inSize) {
+    RunInPlace("square_magnitude", inOutVector, inSize);
+  }
+
+  // c = a + b. inWidth selects the scalar (1), int4 (4) or int8 (8) kernel.
+  void VectorAdd(const int* inA, const int* inB, int* outC, const int inSize, const int inWidth = 1) {
+    const size_t aBytes = inSize * sizeof(int);
+    cl_mem aBufferA = AcquireBuffer(aBytes, CL_MEM_READ_ONLY);
+    cl_mem aBufferB = AcquireBuffer(aBytes, CL_MEM_READ_ONLY);
+    cl_mem aBufferC = AcquireBuffer(aBytes, CL_MEM_WRITE_ONLY);
+    CheckError(clEnqueueWriteBuffer(fQueue, aBufferA, CL_FALSE, 0, aBytes, inA, 0, NULL,
+                                    fProfiler.Track(CommandKind::Upload, "vector_add", aBytes)),
+               "Couldn't write the buffer");
+    CheckError(clEnqueueWriteBuffer(fQueue, aBufferB, CL_FALSE, 0, aBytes, inB, 0, NULL,
+                                    fProfiler.Track(CommandKind::Upload, "vector_add", aBytes)),
+               "Couldn't write the buffer");
+    VectorAddOnBuffers(aBufferA, aBufferB, aBufferC, inSize, inWidth);
+    CheckError(clEnqueueReadBuffer(fQueue, aBufferC, CL_TRUE, 0, aBytes, outC, 0, NULL,
+                                   fProfiler.Track(CommandKind::Download, "vector_add", aBytes)),
+               "Couldn't read the buffer");
+    ReleaseBuffer(aBufferA);
+    ReleaseBuffer(aBufferB);
+    ReleaseBuffer(aBufferC);
+    fProfiler.Drain();
+  }
+
+  void VectorAddOnBuffers(cl_mem inA, cl_mem inB, cl_mem outC, const int inSize, const int inWidth = 1) {
+    const char* aKernelName = (inWidth == 8 ? "vector_add_int8" : (inWidth == 4 ? "vector_add_int4" : "vector_add"));
+    const int aWidth = (inWidth == 8 || inWidth == 4 ? inWidth : 1);
+    cl_kernel aKernel = GetKernel(aKernelName);
+    clSetKernelArg(aKernel, 0, sizeof(int), &inSize);
+    clSetKernelArg(aKernel, 1, sizeof(cl_mem), &inA);
+    clSetKernelArg(aKernel, 2, sizeof(cl_mem), &inB);
+    clSetKernelArg(aKernel, 3, sizeof(cl_mem), &outC);
+    EnqueueKernel1D(aKernelName, (inSize + aWidth - 1) / aWidth);
+  }
+
+  // C += A * B for square row-major inSize x inSize matrices, matching MultiplyMatrices in M2.T1P
+  void MultiplyMatrices(const int* inA, const int* inB, int* inOutC, const int inSize) {
+    MultiplyMatrixRows(inA, inB, inOutC, inSize, inSize);
+  }
+
+  // C[rows] += A[rows] * B, where inA and inOutC point at a band of inRows rows and inB is the full matrix
+  void MultiplyMatrixRows(const int* inA, const int* inB, int* inOutC, const int inSize, const int inRows) {
+    const size_t aBytes = static_cast<size_t>(inSize) * inSize * sizeof(int);
+    const size_t aBandBytes = static_cast<size_t>(inRows) * inSize * sizeof(int);
+    if (!aBandBytes)
+      return;
+    cl_mem aBufferA = AcquireBuffer(aBandBytes, CL_MEM_READ_ONLY);
+    cl_mem aBufferB = AcquireBuffer(aBytes, CL_MEM_READ_ONLY);
+    cl_mem aBufferC = AcquireBuffer(aBandBytes);
+    CheckError(clEnqueueWriteBuffer(fQueue, aBufferA, CL_FALSE, 0, aBandBytes, inA, 0, NULL,
+                                    fProfiler.Track(CommandKind::Upload, "matmul", aBandBytes)),
+               "Couldn't write the buffer");
+    CheckError(clEnqueueWriteBuffer(fQueue, aBufferB, CL_FALSE, 0, aBytes, inB, 0, NULL,
+                                    fProfiler.Track(CommandKind::Upload, "matmul", aBytes)),
+               "Couldn't write the buffer");
+    CheckError(clEnqueueWriteBuffer(fQueue, aBufferC, CL_FALSE, 0, aBandBytes, inOutC, 0, NULL,
+                                    fProfiler.Track(CommandKind::Upload, "matmul", aBandBytes)),
+               "Couldn't write the buffer");
+    MultiplyMatricesOnBuffers(aBufferA, aBufferB, aBufferC, inSize, inRows);
+    CheckError(clEnqueueReadBuffer(fQueue, aBufferC, CL_TRUE, 0, aBandBytes, inOutC, 0, NULL,
+                                   fProfiler.Track(CommandKind::Download, "matmul", aBandBytes)),
+               "Couldn't read the buffer");
+    ReleaseBuffer(aBufferA);
+    ReleaseBuffer(aBufferB);
+    ReleaseBuffer(aBufferC);
+    fProfiler.Drain();
+  }
+
+  // inRows < 0 means a full square multiply
+  void MultiplyMatricesOnBuffers(cl_mem inA, cl_mem inB, cl_mem inOutC, const int inSize, const int inRows = -1) {
+    const int aRows = (inRows < 0 ? inSize : inRows);
+    const size_t aTile = GetMatmulTile();
+    cl_kernel aKernel = GetKernel("matmul");
+    clSetKernelArg(aKernel, 0, sizeof(int), &inSize);
+    clSetKernelArg(aKernel, 1, sizeof(int), &aRows);
+    clSetKernelArg(aKernel, 2, sizeof(cl_mem), &inA);
+    clSetKernelArg(aKernel, 3, sizeof(cl_mem), &inB);
+    clSetKernelArg(aKernel, 4, sizeof(cl_mem), &inOutC);
+    // NULL with a size allocates that much local memory per work-group
+    clSetKernelArg(aKernel, 5, aTile * aTile * sizeof(int), NULL);
+    clSetKernelArg(aKernel, 6, aTile * aTile * sizeof(int), NULL);
+    const size_t aGlobal[2] = {((inSize + aTile - 1) / aTile) * aTile, ((aRows + aTile - 1) / aTile) * aTile};
+    const size_t aLocal[2] = {aTile, aTile};
+    CheckError(clEnqueueNDRangeKernel(fQueue, aKernel, 2, NULL, aGlobal, aLocal, 0, NULL,
+                                      fProfiler.Track(CommandKind::Kernel, "matmul")),
+               "Couldn't enqueue the kernel");
+  }
+
+  // Tuned tile edge, or the largest power of two up to 16 whose tile fits in a work-group
+  size_t GetMatmulTile() {
+    size_t aTile = GetLocalSize("matmul");
+    if (aTile)
+      return aTile;
+    const size_t aMaxWorkGroup = GetMaxWorkGroupSize("matmul");
+    aTile = 16;
+    while (aTile > 1 && aTile * aTile > aMaxWorkGroup) {
+      aTile /= 2;
+    }
+    return aTile;
+  }
+
+  cl_device_id fDevice;
+  cl_context fContext;
+  cl_command_queue fQueue;
+  cl_program fProgram;
+  bool fLoadedFromCache = false;
+  // Set fProfiler.fEnabled to time every enqueue the engine makes (see opencl_profiler.h)
+  CommandProfiler fProfiler;
+
+  private:
+  void RunInPlaceOnBuffer(const char* inKernelName, cl_mem inBuffer, const int inSize) {
+    cl_kernel aKernel = GetKernel(inKernelName);
+    clSetKernelArg(aKernel, 0, sizeof(int), &inSize);
+    clSetKernelArg(aKernel, 1, sizeof(cl_mem), &inBuffer);
+    EnqueueKernel1D(inKernelName, inSize);
+  }
+
+  cl_command_queue GetTransferQueue(const int inIndex) {
+    if (fTransferQueues[inIndex] == NULL) {
+      cl_int aError = CL_SUCCESS;
+      fTransferQueues[inIndex] = clCreateCommandQueueWithProperties(fContext, fDevice, kQueueProperties, &aError);
+      CheckError(aError, "Couldn't create a command queue");
+    }
+    return fTransferQueues[inIndex];
+  }
+
+  // Loads the program from <cacheDir>/<file>.<hash>.bin when a binary for this exact source, device
+  // and driver exists, otherwise compiles the source and stores the resulting binary for next time.
+  cl_program BuildProgram(const char* inProgramFile, const char* inCacheDir) {
+    std::string aSource;
+    if (!ReadFile(inProgramFile, aSource)) {
+      perror("Couldn't find the program file");
+      exit(1);
+    }
+
+    uint64_t aHash = HashString(aSource);
+    aHash = HashString(GetDeviceString(fDevice, CL_DEVICE_NAME), aHash);
+    aHash = HashString(GetDeviceString(fDevice, CL_DRIVER_VERSION), aHash);
+    aHash = HashString(fBuildOptions, aHash);
+    std::string aFileName(inProgramFile);
+    const std::size_t aSlash = aFileName.find_last_of('/');
+    if (aSlash != std::string::npos) {
+      aFileName = aFileName.substr(aSlash + 1);
+    }
+    char aHashText[17];
+    snprintf(aHashText, sizeof(aHashText), "%016llx", static_cast<unsigned long long>(aHash));
+    const std::string aCachePath = std::string(inCacheDir) + "/" + aFileName + "." + aHashText + ".bin";
+
+    cl_int aError = CL_SUCCESS;
+    std::string aBinary;
+    if (ReadFile(aCachePath, aBinary) && !aBinary.empty()) {
+      const size_t aBinarySize = aBinary.size();
+      const unsigned char* aBinaryData = reinterpret_cast<const unsigned char*>(aBinary.data());
+      cl_int aBinaryStatus = CL_SUCCESS;
+      cl_program aProgram = clCreateProgramWithBinary(fContext, 1, &fDevice, &aBinarySize, &aBinaryData,
+                                                      &aBinaryStatus, &aError);
+      if (aError == CL_SUCCESS && aBinaryStatus == CL_SUCCESS &&
+          clBuildProgram(aProgram, 1, &fDevice, fBuildOptions.c_str(), NULL, NULL) == CL_SUCCESS) {
+        fLoadedFromCache = true;
+        return aProgram;
+      }
+      // A stale or foreign binary is not fatal, the source build below replaces it
+      if (aProgram != NULL) {
+        clReleaseProgram(aProgram);
+      }
+    }
+
+    const char* aSourceData = aSource.c_str();
+    const size_t aSourceSize = aSource.size();
+    cl_program aProgram = clCreateProgramWithSource(fContext, 1, &aSourceData, &aSourceSize, &aError);
+    CheckError(aError, "Couldn't create the program");
+
+    aError = clBuildProgram(aProgram, 1, &fDevice, fBuildOptions.c_str(), NULL, NULL);
+    if (aError < 0) {
+      size_t aLogSize = 0;
+      clGetProgramBuildInfo(aProgram, fDevice, CL_PROGRAM_BUILD_LOG, 0, NULL, &aLogSize);
+      std::string aLog(aLogSize, '\0');
+      clGetProgramBuildInfo(aProgram, fDevice, CL_PROGRAM_BUILD_LOG, aLogSize, &aLog[0], NULL);
+      printf("%s\n", aLog.c_str());
+      exit(1);
+    }
+
+    size_t aBinarySize = 0;
+    clGetProgramInfo(aProgram, CL_PROGRAM_BINARY_SIZES, sizeof(size_t), &aBinarySize, NULL);
+    if (aBinarySize) {
+      std::vector<unsigned char> aBinaryData(aBinarySize);
+      unsigned char* aBinaryPointer = aBinaryData.data();
+      clGetProgramInfo(aProgram, CL_PROGRAM_BINARIES, sizeof(unsigned char*), &aBinaryPointer, NULL);
+      FILE* aHandle = fopen(aCachePath.c_str(), "wb");
+      if (aHandle != NULL) {
+        fwrite(aBinaryData.data(), 1, aBinarySize, aHandle);
+        fclose(aHandle);
+      }
+    }
+    return aProgram;
+  }
+
+  std::string fBuildOptions;
+  std::map<std::string, cl_kernel> fKernels;
+  std::map<std::string, size_t> fLocalSizes;
+  std::vector<PooledBuffer> fBufferPool;
+  std::vector<PooledBuffer> fBuffersInUse;
+  cl_command_queue fTransferQueues[2] = {NULL, NULL};
+} OpenCLEngine;
+
+#endif // OPENCL_ENGINE_H
@@ -0,0 +1,248 @@
+#ifndef OPENCL_PIPELINE_H
+#define OPENCL_PIPELINE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "opencl_engine.h"
+
+// OpenCLPipeline enqueues a DAG of kernels from vector_ops.cl on one engine. Stages are linked through event
+// wait lists rather than host synchronisation, intermediate buffers never leave the device, and only the
+// buffer the caller reads back crosses to the host, so a chain such as generate -> add -> square -> reduce
+// costs one device to host transfer instead of a round trip per stage.
+//
+// Stages run on a dedicated out-of-order queue when the device supports one, so independent stages (e.g.
+// generating two inputs) may overlap; otherwise an in-order queue gives the same results serially.
+//
+//   OpenCLPipeline aPipeline(aEngine);
+//   const int aA = aPipeline.AddBuffer(n * sizeof(int));
+//   const int aGenerate = aPipeline.AddStage("generate", n, {IntArg(n), UIntArg(seed), BufferArg(aA)});
+//   const int aSum = aPipeline.AddReduceSum(aA, n, {aGenerate});
+//   aPipeline.Run();
+//   const int64_t aTotal = aPipeline.ReadScalar<int64_t>(aPipeline.ResultBuffer(aSum));
+
+// Host copy of the generate kernel's hash
+inline int HashIndex(const uint32_t inIndex, const uint32_t inSeed) {
+  uint32_t x = (inIndex * 0x9E3779B1u) ^ inSeed;
+  x ^= x >> 16;
+  x *= 0x85EBCA6Bu;
+  x ^= x >> 13;
+  x *= 0xC2B2AE35u;
+  x ^= x >> 16;
+  return static_cast<int>(x % 100u);
+}
+
+enum class ArgKind { Int, UInt, Buffer, Local };
+
+// How AddReduceSum folds a vector to one value:
+//   Tree:     reduce_sum (local-memory tree per work-group), then reduce_sum_long over the partials
+//   SubGroup: reduce_sum_subgroup (sub_group_reduce_add per sub-group), then reduce_sum_long
+//   Atomic:   zero_long, then reduce_sum_atomic adds every work-group's total into one value
+enum class ReduceStrategy { Tree, SubGroup, Atomic };
+
+typedef struct KernelArg {
+  ArgKind fKind;
+  int32_t fInt;
+  uint32_t fUInt;
+  int fBuffer;
+  size_t fLocalBytes;
+} KernelArg;
+
+inline KernelArg IntArg(const int32_t inValue) { return {ArgKind::Int, inValue, 0, -1, 0}; }
+inline KernelArg UIntArg(const uint32_t inValue) { return {ArgKind::UInt, 0, inValue, -1, 0}; }
+inline KernelArg BufferArg(const int inBuffer) { return {ArgKind::Buffer, 0, 0, inBuffer, 0}; }
+inline KernelArg LocalArg(const size_t inBytes) { return {ArgKind::Local, 0, 0, -1, inBytes}; }
+
+typedef struct PipelineStage {
+  std::string fKernel;
+  size_t fGlobalSize;
+  size_t fLocalSize; // 0 uses the engine's tuned size for the kernel
+  std::vector<KernelArg> fArgs;
+  std::vector<int> fDependencies;
+  int fOutput; // buffer holding the stage's result, -1 when the stage writes in place
+  cl_event fEvent;
+} PipelineStage;
+
+typedef struct OpenCLPipeline {
+  OpenCLPipeline(OpenCLEngine& inEngine) : fEngine(inEngine) {
+    const cl_queue_properties aOutOfOrder[] = {
+        CL_QUEUE_PROPERTIES, CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE | CL_QUEUE_PROFILING_ENABLE, 0};
+    cl_int aError = CL_SUCCESS;
+    fQueue = clCreateCommandQueueWithProperties(fEngine.fContext, fEngine.fDevice, aOutOfOrder, &aError);
+    if (aError != CL_SUCCESS) {
+      fQueue = clCreateCommandQueueWithProperties(fEngine.fContext, fEngine.fDevice, kQueueProperties, &aError);
+      CheckError(aError, "Couldn't create a pipeline queue");
+    }
+  }
+
+  ~OpenCLPipeline() {
+    clFinish(fQueue);
+    ReleaseEvents();
+    for (const cl_mem aBuffer : fBuffers) {
+      fEngine.ReleaseBuffer(aBuffer);
+    }
+    clReleaseCommandQueue(fQueue);
+  }
+
+  OpenCLPipeline(const OpenCLPipeline&) = delete;
+  OpenCLPipeline& operator=(const OpenCLPipeline&) = delete;
+
+  // Device-only buffer from the engine pool; returns its id for BufferArg
+  int AddBuffer(const size_t inBytes) {
+    fBuffers.push_back(fEngine.AcquireBuffer(inBytes));
+    return static_cast<int>(fBuffers.size() - 1);
+  }
+
+  // Returns the stage id. Dependencies must be ids of stages added earlier, which keeps the stage list in
+  // topological order.
+  int AddStage(const char* inKernel, const size_t inGlobalSize, const std::vector<KernelArg>& inArgs,
+               const std::vector<int>& inDependencies = {}, const size_t inLocalSize = 0, const int inOutput = -1) {
+    fStages.push_back({inKernel, inGlobalSize, inLocalSize, inArgs, inDependencies, inOutput, NULL});
+    return static_cast<int>(fStages.size() - 1);
+  }
+
+  // Adds the passes needed to fold inSize ints in inInput down to a single int64. The result is in
+  // ResultBuffer(<returned stage>).
+  int AddReduceSum(const int inInput, const int inSize, const std::vector<int>& inDependencies,
+                   const ReduceStrategy inStrategy = ReduceStrategy::Tree) {
+    const size_t aLocal = ReductionWorkGroupSize();
+    // Capping the first pass at kMaxReductionGroups groups bounds its partials; the second pass folds them in
+    // one work-group, whose items stride over all of them, so there are never more than two passes
+    size_t aGroups = std::min<size_t>((inSize + aLocal - 1) / aLocal, kMaxReductionGroups);
+    if (!aGroups) {
+      aGroups = 1;
+    }
+    if (inStrategy == ReduceStrategy::Atomic) {
+      const int aTotal = AddBuffer(sizeof(int64_t));
+      const int aZero = AddStage("zero_long", 1, {IntArg(1), BufferArg(aTotal)});
+      std::vector<int> aDependencies(inDependencies);
+      aDependencies.push_back(aZero);
+      return AddStage("reduce_sum_atomic", aGroups * aLocal,
+                      {IntArg(inSize), BufferArg(inInput), BufferArg(aTotal), LocalArg(aLocal * sizeof(int64_t))},
+                      aDependencies, aLocal, aTotal);
+    }
+
+    const int aPartials = AddBuffer(aGroups * sizeof(int64_t));
+    int aStage = AddStage(inStrategy == ReduceStrategy::SubGroup ? "reduce_sum_subgroup" : "reduce_sum", aGroups * aLocal,
+                          {IntArg(inSize), BufferArg(inInput), BufferArg(aPartials), LocalArg(aLocal * sizeof(int64_t))},
+                          inDependencies, aLocal, aPartials);
+    if (aGroups > 1) {
+      const int aTotal = AddBuffer(sizeof(int64_t));
+      aStage = AddStage("reduce_sum_long", aLocal,
+                        {IntArg(static_cast<int>(aGroups)), BufferArg(aPartials), BufferArg(aTotal),
+                         LocalArg(aLocal * sizeof(int64_t))},
+                        {aStage}, aLocal, aTotal);
+    }
+    return aStage;
+  }
+
+  int ResultBuffer(const int inStage) const { return fStages[inStage].fOutput; }
+
+  // Enqueues every stage with its dependencies' events as the wait list and flushes the queue. Nothing is
+  // read back; the host synchronises only in ReadScalar/ReadBuffer.
+  void Run() {
+    ReleaseEvents();
+    for (PipelineStage& aStage : fStages) {
+      cl_kernel aKernel = fEngine.GetKernel(aStage.fKernel.c_str());
+      for (cl_uint i = 0; i < aStage.fArgs.size(); ++i) {
+        const KernelArg& aArg = aStage.fArgs[i];
+        switch (aArg.fKind) {
+          case ArgKind::Int:
+            clSetKernelArg(aKernel, i, sizeof(int32_t), &aArg.fInt);
+            break;
+          case ArgKind::UInt:
+            clSetKernelArg(aKernel, i, sizeof(uint32_t), &aArg.fUInt);
+            break;
+          case ArgKind::Buffer:
+            clSetKernelArg(aKernel, i, sizeof(cl_mem), &fBuffers[aArg.fBuffer]);
+            break;
+          case ArgKind::Local:
+            clSetKernelArg(aKernel, i, aArg.fLocalBytes, NULL);
+            break;
+        }
+      }
+
+      std::vector<cl_event> aWaitList;
+      for (const int aDependency : aStage.fDependencies) {
+        aWaitList.push_back(fStages[aDependency].fEvent);
+      }
+      const size_t aLocalSize = (aStage.fLocalSize ? aStage.fLocalSize : fEngine.GetLocalSize(aStage.fKernel));
+      size_t aGlobal[1] = {aStage.fGlobalSize};
+      size_t aLocal[1] = {aLocalSize};
+      if (aLocalSize) {
+        aGlobal[0] = ((aStage.fGlobalSize + aLocalSize - 1) / aLocalSize) * aLocalSize;
+      }
+      CheckError(clEnqueueNDRangeKernel(fQueue, aKernel, 1, NULL, aGlobal, aLocalSize ? aLocal : NULL,
+                                        static_cast<cl_uint>(aWaitList.size()), aWaitList.empty() ? NULL : aWaitList.data(),
+                                        &aStage.fEvent), "Couldn't enqueue a pipeline stage");
+    }
+    clFlush(fQueue);
+  }
+
+  // Blocking upload into a pipeline buffer, e.g. host data a stage consumes; Run() after it returns sees it
+  void WriteBuffer(const int inBuffer, const void* inData, const size_t inBytes) {
+    CheckError(clEnqueueWriteBuffer(fQueue, fBuffers[inBuffer], CL_TRUE, 0, inBytes, inData, 0, NULL,
+                                    fEngine.fProfiler.Track(CommandKind::Upload, "pipeline", inBytes)),
+               "Couldn't write a pipeline buffer");
+    fEngine.fProfiler.Drain();
+  }
+
+  // Blocking read of the start of a buffer once every stage has completed
+  template <typename T>
+  T ReadScalar(const int inBuffer) {
+    T aValue = T();
+    ReadBuffer(inBuffer, &aValue, sizeof(T));
+    return aValue;
+  }
+
+  void ReadBuffer(const int inBuffer, void* outData, const size_t inBytes) {
+    std::vector<cl_event> aWaitList;
+    for (const PipelineStage& aStage : fStages) {
+      if (aStage.fEvent != NULL) {
+        aWaitList.push_back(aStage.fEvent);
+      }
+    }
+    CheckError(clEnqueueReadBuffer(fQueue, fBuffers[inBuffer], CL_TRUE, 0, inBytes, outData,
+                                   static_cast<cl_uint>(aWaitList.size()), aWaitList.empty() ? NULL : aWaitList.data(),
+                                   fEngine.fProfiler.Track(CommandKind::Download, "pipeline", inBytes)),
+               "Couldn't read the pipeline result");
+    fEngine.fProfiler.Drain();
+  }
+
+  private:
+  // Hands the stage events to the engine's profiler, which releases them (immediately when disabled)
+  void ReleaseEvents() {
+    for (PipelineStage& aStage : fStages) {
+      if (aStage.fEvent != NULL) {
+        clWaitForEvents(1, &aStage.fEvent);
+        fEngine.fProfiler.Adopt(aStage.fEvent, CommandKind::Kernel, aStage.fKernel.c_str());
+        aStage.fEvent = NULL;
+      }
+    }
+    fEngine.fProfiler.Drain();
+  }
+
+  // Largest power of two up to 256 that every reduction kernel accepts
+  size_t ReductionWorkGroupSize() {
+    size_t aMax = 256;
+    for (const char* aKernel : {"reduce_sum", "reduce_sum_long", "reduce_sum_subgroup", "reduce_sum_atomic"}) {
+      aMax = std::min(aMax, fEngine.GetMaxWorkGroupSize(aKernel));
+    }
+    size_t aLocal = 256;
+    while (aLocal > 1 && aLocal > aMax) {
+      aLocal /= 2;
+    }
+    return aLocal;
+  }
+
+  static constexpr size_t kMaxReductionGroups = 1024;
+
+  OpenCLEngine& fEngine;
+  cl_command_queue fQueue;
+  std::vector<cl_mem> fBuffers;
+  std::vector<PipelineStage> fStages;
+} OpenCLPipeline;
+
+#endif // OPENCL_PIPELINE_H
@@ -0,0 +1,145 @@
+#ifndef OPENCL_PROFILER_H
+#define OPENCL_PROFILER_H
+
+#include <CL/cl.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <string>
+
+// CommandProfiler collects CL_QUEUE_PROFILING_ENABLE timestamps for every command the engine enqueues while
+// it is enabled. Commands are tagged as an upload (host to device), download (device to host) or kernel.
+// Drain() folds completed events into running totals and releases them, so long runs do not hold events.
+//
+// Summary() prints one JSON object per run. Its "benchmark", "size" and "duration_us" keys carry the same
+// microsecond duration the CPU benchmarks print as "duration = X microseconds", so logs from both can be
+// lined up side by side.
+
+enum class CommandKind { Upload, Download, Kernel };
+
+typedef struct ProfiledCommand {
+  cl_event fEvent;
+  CommandKind fKind;
+  std::string fName;
+  size_t fBytes;
+} ProfiledCommand;
+
+typedef struct KernelTotals {
+  uint64_t fCount = 0;
+  uint64_t fExecutionNs = 0;
+} KernelTotals;
+
+typedef struct CommandProfiler {
+  // Returns the event slot to hand to clEnqueue*, or NULL when profiling is off
+  cl_event* Track(const CommandKind inKind, const char* inName, const size_t inBytes = 0) {
+    if (!fEnabled)
+      return NULL;
+    fPending.push_back({NULL, inKind, inName, inBytes});
+    return &fPending.back().fEvent;
+  }
+
+  // Takes ownership of an event the caller already has, e.g. from a pipelined enqueue
+  void Adopt(cl_event inEvent, const CommandKind inKind, const char* inName, const size_t inBytes = 0) {
+    if (!fEnabled) {
+      clReleaseEvent(inEvent);
+      return;
+    }
+    fPending.push_back({inEvent, inKind, inName, inBytes});
+  }
+
+  // Every tracked command must have completed (the engine calls this after a blocking read or clFinish)
+  void Drain() {
+    for (const ProfiledCommand& aCommand : fPending) {
+      if (aCommand.fEvent == NULL)
+        continue;
+      cl_ulong aQueued = 0;
+      cl_ulong aSubmit = 0;
+      cl_ulong aStart = 0;
+      cl_ulong aEnd = 0;
+      clGetEventProfilingInfo(aCommand.fEvent, CL_PROFILING_COMMAND_QUEUED, sizeof(aQueued), &aQueued, NULL);
+      clGetEventProfilingInfo(aCommand.fEvent, CL_PROFILING_COMMAND_SUBMIT, sizeof(aSubmit), &aSubmit, NULL);
+      clGetEventProfilingInfo(aCommand.fEvent, CL_PROFILING_COMMAND_START, sizeof(aStart), &aStart, NULL);
+      clGetEventProfilingInfo(aCommand.fEvent, CL_PROFILING_COMMAND_END, sizeof(aEnd), &aEnd, NULL);
+      clReleaseEvent(aCommand.fEvent);
+
+      const uint64_t aExecutionNs = (aEnd > aStart ? aEnd - aStart : 0);
+      switch (aCommand.fKind) {
+        case CommandKind::Upload:
+          fUploadNs += aExecutionNs;
+          fUploadBytes += aCommand.fBytes;
+          break;
+        case CommandKind::Download:
+          fDownloadNs += aExecutionNs;
+          fDownloadBytes += aCommand.fBytes;
+          break;
+        case CommandKind::Kernel: {
+          KernelTotals& aTotals = fKernels[aCommand.fName];
+          aTotals.fCount++;
+          aTotals.fExecutionNs += aExecutionNs;
+          // Launch overhead: from the host enqueueing the kernel to the device starting it
+          fLaunchNs += (aStart > aQueued ? aStart - aQueued : 0);
+          fSubmitToStartNs += (aStart > aSubmit ? aStart - aSubmit : 0);
+          fKernelLaunches++;
+          break;
+        }
+      }
+    }
+    fPending.clear();
+  }
+
+  void Reset() {
+    Drain();
+    fKernels.clear();
+    fUploadNs = fDownloadNs = fUploadBytes = fDownloadBytes = 0;
+    fLaunchNs = fSubmitToStartNs = fKernelLaunches = 0;
+  }
+
+  uint64_t KernelNs() const {
+    uint64_t aTotal = 0;
+    for (const auto& aKernel : fKernels) {
+      aTotal += aKernel.second.fExecutionNs;
+    }
+    return aTotal;
+  }
+
+  void Summary(FILE* inStream, const char* inBenchmark, const char* inDevice, const char* inMode,
+               const uint64_t inSize, const long inDurationUs) {
+    Drain();
+    // bytes per ns is GB/s
+    const double aUploadGbps = (fUploadNs ? static_cast<double>(fUploadBytes) / fUploadNs : 0.0);
+    const double aDownloadGbps = (fDownloadNs ? static_cast<double>(fDownloadBytes) / fDownloadNs : 0.0);
+    const double aLaunchUs = (fKernelLaunches ? fLaunchNs / 1000.0 / fKernelLaunches : 0.0);
+    const double aSubmitUs = (fKernelLaunches ? fSubmitToStartNs / 1000.0 / fKernelLaunches : 0.0);
+    fprintf(inStream,
+            "{\"benchmark\":\"%s\",\"device\":\"%s\",\"mode\":\"%s\",\"size\":%llu,\"duration_us\":%ld,"
+            "\"kernel_ms\":%.3f,\"h2d_ms\":%.3f,\"d2h_ms\":%.3f,\"h2d_gbps\":%.3f,\"d2h_gbps\":%.3f,"
+            "\"launch_overhead_us\":%.3f,\"submit_to_start_us\":%.3f,\"kernels\":{",
+            inBenchmark, inDevice, inMode, static_cast<unsigned long long>(inSize), inDurationUs, KernelNs() / 1e6,
+            fUploadNs / 1e6, fDownloadNs / 1e6, aUploadGbps, aDownloadGbps, aLaunchUs, aSubmitUs);
+    bool aFirst = true;
+    for (const auto& aKernel : fKernels) {
+      fprintf(inStream, "%s\"%s\":{\"count\":%llu,\"ms\":%.3f}", aFirst ? "" : ",", aKernel.first.c_str(),
+              static_cast<unsigned long long>(aKernel.second.fCount), aKernel.second.fExecutionNs / 1e6);
+      aFirst = false;
+    }
+    fprintf(inStream, "}}\n");
+  }
+
+  bool fEnabled = false;
+  std::map<std::string, KernelTotals> fKernels;
+  uint64_t fUploadNs = 0;
+  uint64_t fDownloadNs = 0;
+  uint64_t fUploadBytes = 0;
+  uint64_t fDownloadBytes = 0;
+  uint64_t fLaunchNs = 0;
+  uint64_t fSubmitToStartNs = 0;
+  uint64_t fKernelLaunches = 0;
+
+  private:
+  // A deque keeps the event slots handed out by Track in place as more commands are tracked
+  std::deque<ProfiledCommand> fPending;
+} CommandProfiler;
+
+#endif // OPENCL_PROFILER_H
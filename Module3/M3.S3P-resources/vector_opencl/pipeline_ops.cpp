@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include "opencl_autotuner.h"
+#include "opencl_pipeline.h"
+
+// Runs sum((a + b)^2) with a and b generated from seeds, two ways on the same engine:
+//   chained: generate a, generate b -> vector_add -> square_magnitude -> reduce_sum, all on the device,
+//            linked by events, reading back one 64-bit scalar
+//   naive:   one round trip per stage, i.e. every stage's output is read back and re-uploaded by the next,
+//            and the sum is taken on the host
+// Both are checked against a host reference built from HashIndex.
+
+int SZ = 1 << 20;
+int REPEATS = 10;
+const uint32_t SEED_A = 1;
+const uint32_t SEED_B = 2;
+
+long long chained(OpenCLEngine &engine);
+long long naive(OpenCLEngine &engine, int *a, int *b, int *c);
+long long reference();
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+        SZ = atoi(argv[1]);
+    if (argc > 2)
+        REPEATS = atoi(argv[2]);
+
+    OpenCLEngine engine("./vector_ops.cl");
+    Autotuner tuner(engine);
+    const std::string device = GetDeviceString(engine.fDevice, CL_DEVICE_NAME);
+    const long long expected = reference();
+
+    int *a = (int *)malloc(sizeof(int) * SZ);
+    int *b = (int *)malloc(sizeof(int) * SZ);
+    int *c = (int *)malloc(sizeof(int) * SZ);
+
+    // Warm-up: kernel creation and pool allocation are paid once per engine, not per run
+    chained(engine);
+    naive(engine, a, b, c);
+
+    const char *modes[] = {"chained", "naive"};
+    for (int m = 0; m < 2; m++)
+    {
+        engine.fProfiler.Reset();
+        engine.fProfiler.fEnabled = true;
+        long long sum = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < REPEATS; i++)
+            sum = (m == 0 ? chained(engine) : naive(engine, a, b, c));
+        auto stop = std::chrono::high_resolution_clock::now();
+        engine.fProfiler.fEnabled = false;
+
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+        printf("%s: sum = %lld (%s)\n", modes[m], sum, sum == expected ? "verified" : "MISMATCH");
+        printf("duration = %ld microseconds\n", (long)(duration.count() / (REPEATS > 0 ? REPEATS : 1)));
+        engine.fProfiler.Summary(stdout, "pipeline_ops", device.c_str(), modes[m], SZ, (long)duration.count());
+        if (sum != expected)
+            return 1;
+    }
+
+    free(a);
+    free(b);
+    free(c);
+}
+
+long long chained(OpenCLEngine &engine)
+{
+    OpenCLPipeline pipeline(engine);
+    const int a = pipeline.AddBuffer(sizeof(int) * SZ);
+    const int b = pipeline.AddBuffer(sizeof(int) * SZ);
+    const int c = pipeline.AddBuffer(sizeof(int) * SZ);
+
+    // The two generate stages have no dependency on each other and may overlap on an out-of-order queue
+    const int generateA = pipeline.AddStage("generate", SZ, {IntArg(SZ), UIntArg(SEED_A), BufferArg(a)});
+    const int generateB = pipeline.AddStage("generate", SZ, {IntArg(SZ), UIntArg(SEED_B), BufferArg(b)});
+    const int add = pipeline.AddStage("vector_add", SZ, {IntArg(SZ), BufferArg(a), BufferArg(b), BufferArg(c)},
+                                      {generateA, generateB});
+    const int square = pipeline.AddStage("square_magnitude", SZ, {IntArg(SZ), BufferArg(c)}, {add});
+    const int sum = pipeline.AddReduceSum(c, SZ, {square});
+
+    pipeline.Run();
+    return pipeline.ReadScalar<int64_t>(pipeline.ResultBuffer(sum));
+}
+
+long long naive(OpenCLEngine &engine, int *a, int *b, int *c)
+{
+    // Each generate is its own single-stage pipeline whose output is read back in full
+    {
+        OpenCLPipeline pipeline(engine);
+        const int buffer = pipeline.AddBuffer(sizeof(int) * SZ);
+        pipeline.AddStage("generate", SZ, {IntArg(SZ), UIntArg(SEED_A), BufferArg(buffer)});
+        pipeline.Run();
+        pipeline.ReadBuffer(buffer, a, sizeof(int) * SZ);
+    }
+    {
+        OpenCLPipeline pipeline(engine);
+        const int buffer = pipeline.AddBuffer(sizeof(int) * SZ);
+        pipeline.AddStage("generate", SZ, {IntArg(SZ), UIntArg(SEED_B), BufferArg(buffer)});
+        pipeline.Run();
+        pipeline.ReadBuffer(buffer, b, sizeof(int) * SZ);
+    }
+    engine.VectorAdd(a, b, c, SZ);
+    engine.SquareMagnitude(c, SZ);
+
+    long long sum = 0;
+    for (int i = 0; i < SZ; i++)
+        sum += c[i];
+    return sum;
+}
+
+long long reference()
+{
+    long long sum = 0;
+    for (int i = 0; i < SZ; i++)
+    {
+        const long long value = HashIndex(i, SEED_A) + HashIndex(i, SEED_B);
+        sum += value * value;
+    }
+    return sum;
+}
@@ -0,0 +1,146 @@
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <functional>
+
+#include "opencl_autotuner.h"
+#include "opencl_pipeline.h"
+
+// Sums SZ ints with the CPU strategies of M2.S3P/OMP++-VectorAdd.cpp (OpenMP reduction clause, atomic
+// update per element, per-thread block sum merged in a critical section) and with the on-device reductions
+// of vector_ops.cl (tree, sub-group and atomic). The device vector is uploaded once; each device run reads
+// back only the 64-bit total. Every strategy prints "duration = X microseconds" per sum and a JSON summary.
+
+int SZ = 1000000;
+int REPEATS = 10;
+
+void init(int *&A, int size);
+long long sumReduction(const int *v, int size);
+long long sumAtomic(const int *v, int size);
+long long sumCritical(const int *v, int size);
+bool report(const char *strategy, const char *device, long long sum, long long expected, long durationUs,
+            CommandProfiler &profiler);
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+        SZ = atoi(argv[1]);
+    if (argc > 2)
+        REPEATS = atoi(argv[2]);
+
+    int *v;
+    init(v, SZ);
+    long long expected = 0;
+    for (int i = 0; i < SZ; i++)
+        expected += v[i];
+
+    bool verified = true;
+    CommandProfiler hostProfiler; // never enabled, keeps the host lines in the same JSON shape
+    const char *cpuNames[] = {"cpu_reduction", "cpu_atomic", "cpu_critical"};
+    std::function<long long(const int *, int)> cpuStrategies[] = {sumReduction, sumAtomic, sumCritical};
+    for (int s = 0; s < 3; s++)
+    {
+        long long sum = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < REPEATS; i++)
+            sum = cpuStrategies[s](v, SZ);
+        auto stop = std::chrono::high_resolution_clock::now();
+        verified &= report(cpuNames[s], "host-openmp", sum, expected,
+                           (long)std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count(), hostProfiler);
+    }
+
+    OpenCLEngine engine("./vector_ops.cl");
+    Autotuner tuner(engine);
+    const std::string device = GetDeviceString(engine.fDevice, CL_DEVICE_NAME);
+    const std::string extensions = GetDeviceString(engine.fDevice, CL_DEVICE_EXTENSIONS);
+    printf("sub-groups: %s, 64-bit atomics: %s\n",
+           extensions.find("cl_khr_subgroups") != std::string::npos ? "yes" : "no (tree fallback)",
+           extensions.find("cl_khr_int64_base_atomics") != std::string::npos ? "yes" : "no (32-bit halves)");
+
+    const char *deviceNames[] = {"device_tree", "device_subgroup", "device_atomic"};
+    const ReduceStrategy deviceStrategies[] = {ReduceStrategy::Tree, ReduceStrategy::SubGroup, ReduceStrategy::Atomic};
+    for (int s = 0; s < 3; s++)
+    {
+        OpenCLPipeline pipeline(engine);
+        const int input = pipeline.AddBuffer(sizeof(int) * SZ);
+        pipeline.WriteBuffer(input, v, sizeof(int) * SZ);
+        const int total = pipeline.ResultBuffer(pipeline.AddReduceSum(input, SZ, {}, deviceStrategies[s]));
+
+        // Warm-up outside the timed loop, then time only the reduction and the scalar read back
+        pipeline.Run();
+        pipeline.ReadScalar<int64_t>(total);
+        engine.fProfiler.Reset();
+        engine.fProfiler.fEnabled = true;
+        long long sum = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < REPEATS; i++)
+        {
+            pipeline.Run();
+            sum = pipeline.ReadScalar<int64_t>(total);
+        }
+        auto stop = std::chrono::high_resolution_clock::now();
+        engine.fProfiler.fEnabled = false;
+        verified &= report(deviceNames[s], device.c_str(), sum, expected,
+                           (long)std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count(), engine.fProfiler);
+    }
+
+    free(v);
+    return verified ? 0 : 1;
+}
+
+void init(int *&A, int size)
+{
+    A = (int *)malloc(sizeof(int) * size);
+
+    for (long i = 0; i < size; i++)
+    {
+        A[i] = rand() % 100; // any number less than 100
+    }
+}
+
+long long sumReduction(const int *v, int size)
+{
+    long long total = 0;
+#pragma omp parallel for reduction(+ : total)
+    for (int i = 0; i < size; i++)
+        total += v[i];
+    return total;
+}
+
+long long sumAtomic(const int *v, int size)
+{
+    long long total = 0;
+#pragma omp parallel for
+    for (int i = 0; i < size; i++)
+    {
+#pragma omp atomic update
+        total += v[i];
+    }
+    return total;
+}
+
+long long sumCritical(const int *v, int size)
+{
+    long long total = 0;
+#pragma omp parallel
+    {
+        long long blockSum = 0;
+#pragma omp for
+        for (int i = 0; i < size; i++)
+            blockSum += v[i];
+#pragma omp critical
+        total += blockSum;
+    }
+    return total;
+}
+
+bool report(const char *strategy, const char *device, long long sum, long long expected, long durationUs,
+            CommandProfiler &profiler)
+{
+    printf("%s: sum = %lld (%s)\n", strategy, sum, sum == expected ? "verified" : "MISMATCH");
+    printf("duration = %ld microseconds\n", durationUs / (REPEATS > 0 ? REPEATS : 1));
+    profiler.Summary(stdout, "reduce_ops", device, strategy, SZ, durationUs);
+    return sum == expected;
+}
@@ -0,0 +1,30 @@
+#!/bin/bash
+
+DATA_SIZES=(1000 100000 10000000)
+MATRIX_SIZES=(100 500 1000 2000)
+MODES=(copy hostptr mapped pipelined)
+
+./compile.sh
+./autotune.o
+for SIZE in "${DATA_SIZES[@]}"; do
+  for MODE in "${MODES[@]}"; do
+    ./vector_ops.o ${SIZE} 100 ${MODE} | grep '^{' >> "vector_ops_${MODE}_${SIZE}.jsonl"
+  done
+done
+for SIZE in "${MATRIX_SIZES[@]}"; do
+  for i in {1..10}; do
+    ./matrix_ops.o ${SIZE} | grep '^{' >> "matrix_ops_${SIZE}.jsonl"
+  done
+done
+for SIZE in "${DATA_SIZES[@]}"; do
+  ./hetero_ops.o add ${SIZE} 10 | grep duration | awk '{print $5}' >> "hetero_add_${SIZE}.log"
+done
+for SIZE in "${MATRIX_SIZES[@]}"; do
+  ./hetero_ops.o matmul ${SIZE} 10 | grep duration | awk '{print $5}' >> "hetero_matmul_${SIZE}.log"
+done
+for SIZE in "${DATA_SIZES[@]}"; do
+  ./pipeline_ops.o ${SIZE} 10 | grep '^{' >> "pipeline_ops_${SIZE}.jsonl"
+done
+for SIZE in 1000000 10000000 100000000; do
+  ./reduce_ops.o ${SIZE} 10 | grep '^{' >> "reduce_ops_${SIZE}.jsonl"
+done
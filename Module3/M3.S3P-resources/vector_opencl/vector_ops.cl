@@ -1,25 +1,263 @@
-//ToDo: Add Comment (what is the purpose of this function? Where its going to get executed?)
-__kernel void square_magnitude(const int size,
-                      __global int* v) {
-    
-    // Thread identifiers
-    const int globalIndex = get_global_id(0);   
- 
-    //uncomment to see the index each PE works on
-    //printf("Kernel process index :(%d)\n ", globalIndex);
-
-    v[globalIndex] = v[globalIndex] * v[globalIndex];
-}
-
-//ToDo: Add Comment (what is the purpose of this function? Where its going to get executed?)
-__kernel void vector_add(const int size,
-                      __global int* v) {
-    
-    // Thread identifiers
-    const int globalIndex = get_global_id(0);   
- 
-    //uncomment to see the index each PE works on
-    //printf("Kernel process index :(%d)\n ", globalIndex);
-
-    v[globalIndex] = v[globalIndex] * v[globalIndex];
-}
+// Every kernel below is executed by the OpenCL runtime on the selected device (GPU, or CPU through e.g. PoCL),
+// once per work-item. The host may round the global size up to a multiple of the work-group size, so each
+// kernel checks its index against size before touching memory.
+
+// Squares every element of v in place. One work-item handles one element.
+__kernel void square_magnitude(const int size,
+                      __global int* v) {
+
+    // Thread identifiers
+    const int globalIndex = get_global_id(0);
+    if (globalIndex >= size)
+        return;
+
+    //uncomment to see the index each PE works on
+    //printf("Kernel process index :(%d)\n ", globalIndex);
+
+    v[globalIndex] = v[globalIndex] * v[globalIndex];
+}
+
+// Fills v with pseudo-random values in [0, 100) derived from (index, seed), so a pipeline can create its
+// inputs on the device. HashIndex in opencl_pipeline.h is the host copy used to check results.
+__kernel void generate(const int size,
+                      const uint seed,
+                      __global int* v) {
+
+    const int globalIndex = get_global_id(0);
+    if (globalIndex >= size)
+        return;
+
+    uint x = ((uint)globalIndex * 0x9E3779B1u) ^ seed;
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35u;
+    x ^= x >> 16;
+    v[globalIndex] = (int)(x % 100u);
+}
+
+// Element-wise c = a + b. One work-item handles one element.
+__kernel void vector_add(const int size,
+                      __global const int* a,
+                      __global const int* b,
+                      __global int* c) {
+
+    // Thread identifiers
+    const int globalIndex = get_global_id(0);
+    if (globalIndex >= size)
+        return;
+
+    c[globalIndex] = a[globalIndex] + b[globalIndex];
+}
+
+// c = a + b with one work-item per 4 elements. The host launches ceil(size / 4) work-items and the last
+// one finishes any tail that does not fill a whole int4.
+__kernel void vector_add_int4(const int size,
+                      __global const int* a,
+                      __global const int* b,
+                      __global int* c) {
+
+    const int firstIndex = get_global_id(0) * 4;
+    if (firstIndex + 4 <= size) {
+        vstore4(vload4(0, a + firstIndex) + vload4(0, b + firstIndex), 0, c + firstIndex);
+    } else {
+        for (int i = firstIndex; i < size; i++)
+            c[i] = a[i] + b[i];
+    }
+}
+
+// c = a + b with one work-item per 8 elements, see vector_add_int4
+__kernel void vector_add_int8(const int size,
+                      __global const int* a,
+                      __global const int* b,
+                      __global int* c) {
+
+    const int firstIndex = get_global_id(0) * 8;
+    if (firstIndex + 8 <= size) {
+        vstore8(vload8(0, a + firstIndex) + vload8(0, b + firstIndex), 0, c + firstIndex);
+    } else {
+        for (int i = firstIndex; i < size; i++)
+            c[i] = a[i] + b[i];
+    }
+}
+
+// C += A * B for square, row-major size x size matrices, the same semantics as MultiplyMatrices in M2.T1P.
+// A and C may hold only a band of rows (rows <= size) so a multiply can be split across devices by rows.
+// Each work-group computes a tile x tile block of C, where tile is the (square) work-group size. The matching
+// tile x tile blocks of A and B are staged in local memory (tileA, tileB, sized by the host) so every global
+// element is read once per tile instead of once per multiply-add. Out-of-range elements load as 0.
+__kernel void matmul(const int size,
+                      const int rows,
+                      __global const int* A,
+                      __global const int* B,
+                      __global int* C,
+                      __local int* tileA,
+                      __local int* tileB) {
+
+    const int tile = get_local_size(0);
+    const int localRow = get_local_id(1);
+    const int localCol = get_local_id(0);
+    const int row = get_global_id(1);
+    const int col = get_global_id(0);
+
+    int sum = 0;
+    for (int tileStart = 0; tileStart < size; tileStart += tile) {
+        const int aCol = tileStart + localCol;
+        const int bRow = tileStart + localRow;
+        tileA[localRow * tile + localCol] = (row < rows && aCol < size) ? A[row * size + aCol] : 0;
+        tileB[localRow * tile + localCol] = (bRow < size && col < size) ? B[bRow * size + col] : 0;
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        for (int k = 0; k < tile; k++)
+            sum += tileA[localRow * tile + k] * tileB[k * tile + localCol];
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (row < rows && col < size)
+        C[row * size + col] += sum;
+}
+
+// Sums v into one partial per work-group. Each work-item first accumulates a grid-strided slice of v, so the
+// host can launch far fewer work-items than elements, then the work-group folds its values pairwise in local
+// memory (scratch, one long per work-item). The local size must be a power of two. Running reduce_sum_long
+// over the partials with a single work-group finishes the sum.
+__kernel void reduce_sum(const int size,
+                      __global const int* v,
+                      __global long* partials,
+                      __local long* scratch) {
+
+    const int localIndex = get_local_id(0);
+    long sum = 0;
+    for (int i = get_global_id(0); i < size; i += get_global_size(0))
+        sum += v[i];
+    scratch[localIndex] = sum;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int stride = get_local_size(0) / 2; stride > 0; stride /= 2) {
+        if (localIndex < stride)
+            scratch[localIndex] += scratch[localIndex + stride];
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (localIndex == 0)
+        partials[get_group_id(0)] = scratch[0];
+}
+
+// reduce_sum over 64-bit input, used for the passes after the first
+__kernel void reduce_sum_long(const int size,
+                      __global const long* v,
+                      __global long* partials,
+                      __local long* scratch) {
+
+    const int localIndex = get_local_id(0);
+    long sum = 0;
+    for (int i = get_global_id(0); i < size; i += get_global_size(0))
+        sum += v[i];
+    scratch[localIndex] = sum;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int stride = get_local_size(0) / 2; stride > 0; stride /= 2) {
+        if (localIndex < stride)
+            scratch[localIndex] += scratch[localIndex + stride];
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (localIndex == 0)
+        partials[get_group_id(0)] = scratch[0];
+}
+
+// reduce_sum using sub-group operations instead of a local-memory tree: each sub-group adds its values with
+// sub_group_reduce_add, one long per sub-group goes through scratch and the first sub-group folds those.
+// This needs only one barrier per work-group. Devices without sub-groups get the reduce_sum tree instead,
+// so the host can launch this kernel unconditionally.
+#if defined(cl_khr_subgroups)
+#pragma OPENCL EXTENSION cl_khr_subgroups : enable
+#endif
+__kernel void reduce_sum_subgroup(const int size,
+                      __global const int* v,
+                      __global long* partials,
+                      __local long* scratch) {
+
+    long sum = 0;
+    for (int i = get_global_id(0); i < size; i += get_global_size(0))
+        sum += v[i];
+
+#if defined(cl_khr_subgroups) || defined(__opencl_c_subgroups)
+    sum = sub_group_reduce_add(sum);
+    if (get_sub_group_local_id() == 0)
+        scratch[get_sub_group_id()] = sum;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    if (get_sub_group_id() == 0) {
+        // A work-group may hold more sub-groups than a sub-group has work-items
+        sum = 0;
+        for (uint i = get_sub_group_local_id(); i < get_num_sub_groups(); i += get_sub_group_size())
+            sum += scratch[i];
+        sum = sub_group_reduce_add(sum);
+        if (get_sub_group_local_id() == 0)
+            partials[get_group_id(0)] = sum;
+    }
+#else
+    const int localIndex = get_local_id(0);
+    scratch[localIndex] = sum;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int stride = get_local_size(0) / 2; stride > 0; stride /= 2) {
+        if (localIndex < stride)
+            scratch[localIndex] += scratch[localIndex + stride];
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (localIndex == 0)
+        partials[get_group_id(0)] = scratch[0];
+#endif
+}
+
+// Zeroes v, e.g. the total reduce_sum_atomic accumulates into
+__kernel void zero_long(const int size,
+                      __global long* v) {
+
+    const int globalIndex = get_global_id(0);
+    if (globalIndex >= size)
+        return;
+
+    v[globalIndex] = 0;
+}
+
+// Single-pass reduction: every work-group reduces its slice with the reduce_sum tree and adds the result to
+// total[0] atomically, so no second pass is needed. total must be zeroed first (zero_long). Without 64-bit
+// atomics the total is kept as two 32-bit halves (low word first) and the carry out of the low half is
+// added to the high half; this is exact because every partial is non-negative.
+#if defined(cl_khr_int64_base_atomics)
+#pragma OPENCL EXTENSION cl_khr_int64_base_atomics : enable
+#endif
+__kernel void reduce_sum_atomic(const int size,
+                      __global const int* v,
+                      __global long* total,
+                      __local long* scratch) {
+
+    const int localIndex = get_local_id(0);
+    long sum = 0;
+    for (int i = get_global_id(0); i < size; i += get_global_size(0))
+        sum += v[i];
+    scratch[localIndex] = sum;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int stride = get_local_size(0) / 2; stride > 0; stride /= 2) {
+        if (localIndex < stride)
+            scratch[localIndex] += scratch[localIndex + stride];
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (localIndex != 0)
+        return;
+#if defined(cl_khr_int64_base_atomics)
+    atom_add(total, scratch[0]);
+#else
+    __global volatile uint* halves = (__global volatile uint*)total;
+    const ulong partial = (ulong)scratch[0];
+    const uint low = (uint)partial;
+    const uint previous = atomic_add(&halves[0], low);
+    atomic_add(&halves[1], (uint)(partial >> 32) + (previous + low < previous ? 1u : 0u));
+#endif
+}